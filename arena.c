@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t size;
+    size_t used;
+};
+
+// Data starts after the header, on an ARENA_ALIGN boundary
+#define BLOCK_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+static ArenaBlock *add_block(Arena *arena, size_t size) {
+    ArenaBlock *block = malloc(BLOCK_HEADER + size);
+
+    if (!block) {
+        return NULL;
+    }
+    block->next = arena->blocks;
+    block->size = size;
+    block->used = 0;
+    arena->blocks = block;
+    arena->stats.heap_calls++;
+    arena->stats.capacity += size;
+    return block;
+}
+
+void arena_init(Arena *arena, size_t block_bytes) {
+    memset(arena, 0, sizeof(*arena));
+    arena->block_bytes = block_bytes ? block_bytes : ARENA_DEFAULT_BLOCK;
+}
+
+void arena_free(Arena *arena) {
+    while (arena->blocks) {
+        ArenaBlock *next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+    arena->used = 0;
+    arena->stats.capacity = 0;
+}
+
+void *arena_alloc(Arena *arena, size_t bytes) {
+    ArenaBlock *block = arena->blocks;
+    size_t rounded = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    // What is left of a block too small for this request goes unused
+    if (!block || block->size - block->used < rounded) {
+        size_t size = arena->block_bytes ? arena->block_bytes : ARENA_DEFAULT_BLOCK;
+        block = add_block(arena, rounded > size ? rounded : size);
+        if (!block) {
+            return NULL;
+        }
+    }
+    void *memory = (char *)block + BLOCK_HEADER + block->used;
+    block->used += rounded;
+    arena->used += rounded;
+    if (arena->used > arena->stats.peak) {
+        arena->stats.peak = arena->used;
+    }
+    arena->stats.allocations++;
+    return memory;
+}
+
+void *arena_calloc(Arena *arena, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *memory = arena_alloc(arena, count * size);
+    if (memory) {
+        memset(memory, 0, count * size);
+    }
+    return memory;
+}
+
+void arena_reset(Arena *arena) {
+    if (arena->blocks && arena->blocks->next) {
+        // Merge into one block, so the same work fits without malloc next time
+        size_t total = arena->stats.capacity;
+        arena_free(arena);
+        if (total > arena->block_bytes) {
+            arena->block_bytes = total;
+        }
+        add_block(arena, arena->block_bytes);  // On failure the next allocation retries
+    }
+    if (arena->blocks) {
+        arena->blocks->used = 0;
+    }
+    arena->used = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bump allocator for the scratch memory of one solve: frontier layers, work
+// queues, the bidirectional table. Allocations are carved from large blocks
+// and never freed one by one; a reset drops them all at once. A reset also
+// merges the blocks into one of their combined size, so an arena that is
+// reset between solves settles on a single block and stops calling malloc.
+// Not thread-safe: give each thread its own.
+
+// Alignment of every allocation
+#define ARENA_ALIGN 16
+
+// Size of the first block when none is given
+#define ARENA_DEFAULT_BLOCK ((size_t)64 << 10)
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    uint64_t allocations;  // Allocations handed out
+    uint64_t heap_calls;   // Blocks taken from malloc
+    size_t peak;           // Most bytes in use between two resets
+    size_t capacity;       // Bytes held in blocks
+} ArenaStats;
+
+typedef struct {
+    ArenaBlock *blocks;    // Newest first; allocations come from the newest
+    size_t block_bytes;
+    size_t used;           // Bytes in use since the last reset
+    ArenaStats stats;      // Totals since arena_init
+} Arena;
+
+// No memory is taken until the first allocation; a zeroed arena is ready
+// to use with the default block size
+void arena_init(Arena *arena, size_t block_bytes);
+void arena_free(Arena *arena);
+
+// NULL when out of memory
+void *arena_alloc(Arena *arena, size_t bytes);
+void *arena_calloc(Arena *arena, size_t count, size_t size);
+
+// Drop every allocation, keeping the memory
+void arena_reset(Arena *arena);
+
+#endif // ARENA_H
@@ -0,0 +1,394 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <sys/stat.h>
+#include "assetpack.h"
+#include "pdb.h"
+
+static const char pack_magic[8] = {'T', 'Q', 'P', 'A', 'C', 'K', 0, 0};
+
+// Manifest
+void asset_path(int asset, char *path, size_t length) {
+    if (asset < ASSET_NUMBER_COUNT) {
+        snprintf(path, length, "images/numbers/N%d.bmp", asset + 1);
+    } else {
+        snprintf(path, length, "images/inteface/%d.bmp", asset - ASSET_NUMBER_COUNT + 1);
+    }
+}
+
+// Tiles are stretched square, screens fill the window
+void asset_size(int asset, int *width, int *height) {
+    if (asset < ASSET_NUMBER_COUNT) {
+        *width = ASSET_TILE_SIZE;
+        *height = ASSET_TILE_SIZE;
+    } else {
+        *width = ASSET_SCREEN_WIDTH;
+        *height = ASSET_SCREEN_HEIGHT;
+    }
+}
+
+uint64_t asset_source_stamp(int *present) {
+    uint64_t stamp = 0;
+    int found = 0;
+
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        char path[64];
+        struct stat st;
+        uint64_t fields[2] = {0, 0};
+
+        asset_path(asset, path, sizeof(path));
+        if (stat(path, &st) == 0) {
+            fields[0] = (uint64_t)st.st_size;
+            fields[1] = (uint64_t)st.st_mtime;
+            found++;
+        }
+        stamp = pdb_checksum(fields, sizeof(fields), stamp);
+    }
+    if (present) {
+        *present = found;
+    }
+    return stamp;
+}
+
+// BMP decoding
+static uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+int asset_load_bmp(const char *path, int width, int height, uint8_t *rgb) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *data = file_size > 54 ? malloc((size_t)file_size) : NULL;
+    int ok = data && fread(data, 1, (size_t)file_size, file) == (size_t)file_size;
+    fclose(file);
+
+    // Only the uncompressed layouts SDL_SaveBMP and paint programs write
+    uint32_t pixel_offset = ok ? read_u32(data + 10) : 0;
+    int32_t source_width = ok ? (int32_t)read_u32(data + 18) : 0;
+    int32_t source_height = ok ? (int32_t)read_u32(data + 22) : 0;
+    int bytes_per_pixel = ok ? read_u16(data + 28) / 8 : 0;
+    int top_down = source_height < 0;
+    if (top_down) {
+        source_height = -source_height;
+    }
+    size_t pitch = ((size_t)source_width * (size_t)bytes_per_pixel + 3) & ~(size_t)3;
+    ok = ok && data[0] == 'B' && data[1] == 'M' && read_u32(data + 30) == 0 &&
+         (bytes_per_pixel == 3 || bytes_per_pixel == 4) &&
+         source_width > 0 && source_height > 0 &&
+         pixel_offset + pitch * (size_t)source_height <= (size_t)file_size;
+
+    // Nearest neighbour, sampling each target pixel's centre
+    for (int y = 0; ok && y < height; y++) {
+        int sy = (int)(((int64_t)y * 2 + 1) * source_height / (height * 2));
+        const uint8_t *row = data + pixel_offset +
+                             pitch * (size_t)(top_down ? sy : source_height - 1 - sy);
+        for (int x = 0; x < width; x++) {
+            int sx = (int)(((int64_t)x * 2 + 1) * source_width / (width * 2));
+            const uint8_t *bgr = row + (size_t)sx * (size_t)bytes_per_pixel;
+            *rgb++ = bgr[2];
+            *rgb++ = bgr[1];
+            *rgb++ = bgr[0];
+        }
+    }
+    free(data);
+    return ok;
+}
+
+// Compression
+// A sequence is a token (literal count << 4 | match length - 4), counts of
+// 15 continued in bytes of up to 255, the literals, then a two-byte match
+// offset. The last sequence has literals only.
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 14
+
+static size_t put_length(uint8_t *dest, size_t out, size_t length) {
+    while (length >= 255) {
+        dest[out++] = 255;
+        length -= 255;
+    }
+    dest[out++] = (uint8_t)length;
+    return out;
+}
+
+static size_t put_sequence(uint8_t *dest, size_t out, const uint8_t *literals,
+                           size_t literal_count, size_t offset, size_t match_length) {
+    size_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+    dest[out++] = (uint8_t)((literal_count < 15 ? literal_count : 15) << 4 |
+                            (match_code < 15 ? match_code : 15));
+    if (literal_count >= 15) {
+        out = put_length(dest, out, literal_count - 15);
+    }
+    memcpy(dest + out, literals, literal_count);
+    out += literal_count;
+
+    if (match_length) {
+        dest[out++] = (uint8_t)offset;
+        dest[out++] = (uint8_t)(offset >> 8);
+        if (match_code >= 15) {
+            out = put_length(dest, out, match_code - 15);
+        }
+    }
+    return out;
+}
+
+size_t asset_compress_bound(size_t length) {
+    return length + length / 255 + 16;
+}
+
+// Greedy parse against a hash of the last position each 4-byte string was seen
+size_t asset_compress(const uint8_t *source, size_t length, uint8_t *dest) {
+    uint32_t *table = calloc((size_t)1 << LZ_HASH_BITS, sizeof(uint32_t));  // Position + 1, 0 if none
+    size_t in = 0, anchor = 0, out = 0;
+
+    if (!table) {
+        return 0;
+    }
+    while (in + LZ_MIN_MATCH <= length) {
+        uint32_t sequence, candidate_sequence;
+        memcpy(&sequence, source + in, sizeof(sequence));
+        uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        size_t candidate = table[hash];
+        table[hash] = (uint32_t)(in + 1);
+
+        if (candidate && in - (candidate - 1) <= LZ_MAX_OFFSET) {
+            size_t match = candidate - 1;
+            memcpy(&candidate_sequence, source + match, sizeof(candidate_sequence));
+            if (candidate_sequence == sequence) {
+                size_t match_length = LZ_MIN_MATCH;
+                while (in + match_length < length && source[match + match_length] == source[in + match_length]) {
+                    match_length++;
+                }
+                out = put_sequence(dest, out, source + anchor, in - anchor, in - match, match_length);
+                in += match_length;
+                anchor = in;
+                continue;
+            }
+        }
+        in++;
+    }
+
+    free(table);
+    return put_sequence(dest, out, source + anchor, length - anchor, 0, 0);
+}
+
+static int get_length(const uint8_t *source, size_t length, size_t *in, size_t *value) {
+    uint8_t byte;
+    do {
+        if (*in >= length) {
+            return 0;
+        }
+        byte = source[(*in)++];
+        *value += byte;
+    } while (byte == 255);
+    return 1;
+}
+
+// Returns the decompressed size, or 0 if the input is malformed or too big
+size_t asset_decompress(const uint8_t *source, size_t length, uint8_t *dest, size_t capacity) {
+    size_t in = 0, out = 0;
+
+    while (in < length) {
+        uint8_t token = source[in++];
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && !get_length(source, length, &in, &literal_count)) {
+            return 0;
+        }
+        if (literal_count > length - in || literal_count > capacity - out) {
+            return 0;
+        }
+        memcpy(dest + out, source + in, literal_count);
+        in += literal_count;
+        out += literal_count;
+        if (in == length) {
+            break;
+        }
+
+        if (length - in < 2) {
+            return 0;
+        }
+        size_t offset = (size_t)source[in] | (size_t)source[in + 1] << 8;
+        size_t match_length = token & 15;
+        in += 2;
+        if (match_length == 15 && !get_length(source, length, &in, &match_length)) {
+            return 0;
+        }
+        match_length += LZ_MIN_MATCH;
+        if (offset == 0 || offset > out || match_length > capacity - out) {
+            return 0;
+        }
+
+        // Overlapping matches repeat a short run and must go byte by byte
+        const uint8_t *from = dest + out - offset;
+        if (offset >= match_length) {
+            memcpy(dest + out, from, match_length);
+        } else {
+            for (size_t i = 0; i < match_length; i++) {
+                dest[out + i] = from[i];
+            }
+        }
+        out += match_length;
+    }
+    return out;
+}
+
+// Pack files
+static uint64_t header_checksum(const AssetPackHeader *header) {
+    return pdb_checksum(header, offsetof(AssetPackHeader, header_checksum), 0);
+}
+
+int asset_pack_build(const char *path, FILE *log) {
+    AssetPackHeader header;
+    uint8_t *payloads[ASSET_COUNT] = {0};
+    int ok = 1;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, pack_magic, sizeof(pack_magic));
+    header.version = ASSET_PACK_VERSION;
+    header.entry_count = ASSET_COUNT;
+    header.source_stamp = asset_source_stamp(NULL);
+
+    uint64_t offset = sizeof(header);
+    for (int asset = 0; ok && asset < ASSET_COUNT; asset++) {
+        AssetPackEntry *entry = &header.entries[asset];
+        char source[64];
+        int width, height;
+
+        asset_path(asset, source, sizeof(source));
+        asset_size(asset, &width, &height);
+        size_t raw_size = (size_t)width * (size_t)height * 3;
+        uint8_t *rgb = malloc(raw_size);
+        payloads[asset] = malloc(asset_compress_bound(raw_size));
+        if (!rgb || !payloads[asset]) {
+            free(rgb);
+            ok = 0;
+            break;
+        }
+
+        if (!asset_load_bmp(source, width, height, rgb)) {
+            fprintf(stderr, "Missing or unreadable image %s, it will be drawn plain\n", source);
+            free(rgb);
+            continue;
+        }
+        entry->width = (uint32_t)width;
+        entry->height = (uint32_t)height;
+        entry->offset = offset;
+        entry->compressed_size = asset_compress(rgb, raw_size, payloads[asset]);
+        entry->checksum = pdb_checksum(payloads[asset], (size_t)entry->compressed_size, 0);
+        offset += entry->compressed_size;
+        free(rgb);
+        ok = entry->compressed_size > 0;
+        if (log) {
+            fprintf(log, "  %-24s %4dx%-4d %8zu -> %8llu bytes\n", source, width, height,
+                    raw_size, (unsigned long long)entry->compressed_size);
+        }
+    }
+    header.header_checksum = header_checksum(&header);
+
+    char temp_path[1024];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE *file = ok ? fopen(temp_path, "wb") : NULL;
+    if (file) {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        for (int asset = 0; ok && asset < ASSET_COUNT; asset++) {
+            size_t size = (size_t)header.entries[asset].compressed_size;
+            ok = fwrite(payloads[asset], 1, size, file) == size;
+        }
+        ok = (fclose(file) == 0) && ok;
+        if (ok) {
+#ifdef _WIN32
+            remove(path);
+#endif
+            ok = rename(temp_path, path) == 0;
+        }
+        if (!ok) {
+            remove(temp_path);
+        }
+    } else {
+        ok = 0;
+    }
+
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        free(payloads[asset]);
+    }
+    return ok;
+}
+
+int asset_pack_open(AssetPack *pack, const char *path) {
+    memset(pack, 0, sizeof(*pack));
+    if (!map_file(&pack->file, path)) {
+        return 0;
+    }
+
+    const AssetPackHeader *header = pack->file.data;
+    int ok = pack->file.size >= sizeof(AssetPackHeader) &&
+             memcmp(header->magic, pack_magic, sizeof(pack_magic)) == 0 &&
+             header->version == ASSET_PACK_VERSION &&
+             header->entry_count == ASSET_COUNT &&
+             header->header_checksum == header_checksum(header);
+    for (int asset = 0; ok && asset < ASSET_COUNT; asset++) {
+        const AssetPackEntry *entry = &header->entries[asset];
+        int width, height;
+        asset_size(asset, &width, &height);
+        ok = (entry->width == 0 ||
+              (entry->width == (uint32_t)width && entry->height == (uint32_t)height)) &&
+             entry->offset <= pack->file.size &&
+             entry->compressed_size <= pack->file.size - entry->offset;
+    }
+    if (!ok) {
+        fprintf(stderr, "Invalid asset pack: %s\n", path);
+        asset_pack_close(pack);
+        return 0;
+    }
+    pack->header = header;
+    return 1;
+}
+
+int asset_pack_verify(const AssetPack *pack, int asset) {
+    const AssetPackEntry *entry = &pack->header->entries[asset];
+    const uint8_t *compressed = (const uint8_t *)pack->file.data + entry->offset;
+    return pdb_checksum(compressed, (size_t)entry->compressed_size, 0) == entry->checksum;
+}
+
+void asset_pack_close(AssetPack *pack) {
+    unmap_file(&pack->file);
+    pack->header = NULL;
+}
+
+// The RGB stream is decompressed into the back three quarters of the RGBA
+// buffer, then expanded forwards: pixel i is read before pixel i is written
+int asset_pack_decode(const AssetPack *pack, int asset, uint8_t *rgba) {
+    const AssetPackEntry *entry = &pack->header->entries[asset];
+    const uint8_t *compressed = (const uint8_t *)pack->file.data + entry->offset;
+    size_t pixels = (size_t)entry->width * entry->height;
+
+    if (entry->width == 0) {
+        return 0;
+    }
+    uint8_t *rgb = rgba + pixels;
+    if (asset_decompress(compressed, (size_t)entry->compressed_size, rgb, pixels * 3) != pixels * 3) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < pixels; i++) {
+        rgba[0] = rgb[0];
+        rgba[1] = rgb[1];
+        rgba[2] = rgb[2];
+        rgba[3] = 255;
+        rgb += 3;
+        rgba += 4;
+    }
+    return 1;
+}
@@ -0,0 +1,75 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "mapfile.h"
+
+// Asset pack: every tile and interface image, pre-scaled to the size it is
+// drawn at and compressed, in one file that is memory-mapped at startup.
+// Building a pack needs only the BMP sources, not SDL.
+#define ASSET_PACK_VERSION 1
+#define ASSET_NUMBER_COUNT 24   // images/numbers/N<i + 1>.bmp
+#define ASSET_UI_COUNT 5        // images/inteface/<i + 1>.bmp
+#define ASSET_COUNT (ASSET_NUMBER_COUNT + ASSET_UI_COUNT)
+#define ASSET_TILE_SIZE 192     // Largest tile drawn is (600 - 100) / 3 pixels
+#define ASSET_SCREEN_WIDTH 800
+#define ASSET_SCREEN_HEIGHT 600
+
+// Index entry; width == 0 when the source image was missing at build time
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;           // Compressed data, from the start of the file
+    uint64_t compressed_size;
+    uint64_t checksum;         // Of the compressed bytes
+} AssetPackEntry;
+
+// On-disk header (little-endian, compressed images follow)
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint64_t source_stamp;     // asset_source_stamp() when the pack was built
+    AssetPackEntry entries[ASSET_COUNT];
+    uint64_t header_checksum;
+} AssetPackHeader;
+
+typedef struct {
+    MappedFile file;
+    const AssetPackHeader *header;
+} AssetPack;
+
+// Source image of an asset and the size it is packed at
+void asset_path(int asset, char *path, size_t length);
+void asset_size(int asset, int *width, int *height);
+
+// Fingerprint of the source images from their sizes and times; *present
+// (if set) receives how many of them exist
+uint64_t asset_source_stamp(int *present);
+
+// Decode an uncompressed 24 or 32-bit BMP, scaled (nearest neighbour) to
+// width x height, into packed RGB rows
+int asset_load_bmp(const char *path, int width, int height, uint8_t *rgb);
+
+// Read every source image and write a pack through a temp file; missing
+// images are reported and left empty. Progress goes to log if set.
+int asset_pack_build(const char *path, FILE *log);
+
+// Map a pack read-only; only the header checksum is checked here so opening
+// stays instant, asset_pack_verify() checks an image's compressed bytes
+int asset_pack_open(AssetPack *pack, const char *path);
+void asset_pack_close(AssetPack *pack);
+int asset_pack_verify(const AssetPack *pack, int asset);
+
+// Decompress one image into width * height RGBA pixels; malformed data
+// fails instead of overrunning. Safe to call from several threads at once.
+int asset_pack_decode(const AssetPack *pack, int asset, uint8_t *rgba);
+
+// Byte-oriented LZ77 codec (LZ4-style sequences, 64 KB window)
+size_t asset_compress_bound(size_t length);
+size_t asset_compress(const uint8_t *source, size_t length, uint8_t *dest);
+size_t asset_decompress(const uint8_t *source, size_t length, uint8_t *dest, size_t capacity);
+
+#endif // ASSETPACK_H
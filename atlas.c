@@ -0,0 +1,260 @@
+#include "functions.h"
+#include "assetpack.h"
+
+// Texture atlas
+// Every number tile and interface image is packed into one RGBA texture so
+// a frame's tiles draw from a single texture in one geometry batch. Images
+// come from the asset pack, which is mapped and decoded on worker threads
+// while the menu already renders; the main thread uploads each image into
+// its place in the atlas as it becomes ready. A missing or outdated pack is
+// rebuilt from the BMP sources first. A small digit font is built in, for
+// boards with more tiles than there are images.
+
+#define ATLAS_MAX_WIDTH 2048
+#define ATLAS_WHITE_SIZE 4
+#define ATLAS_PADDING 1         // Keeps filtering from bleeding between images
+#define ATLAS_MAX_WORKERS 4
+#define GLYPH_WIDTH 5
+#define GLYPH_HEIGHT 7
+
+// Digits 0-9, one row per byte, most significant of the low five bits leftmost
+static const uint8_t glyph_rows[10][GLYPH_HEIGHT] = {
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E},
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F},
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02},
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E},
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E},
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C},
+};
+
+// Decoding state shared with the worker threads
+static struct {
+    AssetPack pack;
+    SDL_Thread *workers[ATLAS_MAX_WORKERS];
+    int worker_count;
+    SDL_atomic_t next;                 // Next image to claim
+    SDL_atomic_t ready[ASSET_COUNT];   // Set once pixels[] is final
+    uint8_t *pixels[ASSET_COUNT];      // Decoded RGBA, NULL if decoding failed
+    SDL_bool waiting[ASSET_COUNT];     // Not uploaded yet (main thread only)
+    SDL_Rect rects[ASSET_COUNT];       // Place in the atlas
+    Uint64 start;
+} loader;
+
+// Map the pack, rebuilding it when the source images changed since it was
+// built; a pack shipped without its sources is used as is
+static int open_pack(const char *path) {
+    int present;
+    uint64_t stamp = asset_source_stamp(&present);
+
+    if (asset_pack_open(&loader.pack, path)) {
+        if (present == 0 || loader.pack.header->source_stamp == stamp) {
+            return 1;
+        }
+        asset_pack_close(&loader.pack);
+    }
+    if (present == 0) {
+        fprintf(stderr, "No asset pack at %s and no images to build it from\n", path);
+        return 0;
+    }
+
+    printf("Building asset pack %s\n", path);
+    return asset_pack_build(path, NULL) && asset_pack_open(&loader.pack, path);
+}
+
+// Shelf packing in asset order, then the white block and the digit glyphs:
+// fill rows left to right, each row as tall as its tallest image; returns
+// the atlas height
+static int pack_layout(Atlas *atlas) {
+    int x = 0, y = 0, row_height = 0;
+
+    for (int asset = 0; asset <= ASSET_COUNT + 10; asset++) {
+        int w = ATLAS_WHITE_SIZE, h = ATLAS_WHITE_SIZE;
+        SDL_Rect *rect = asset < ASSET_COUNT ? &loader.rects[asset] :
+                         asset == ASSET_COUNT ? &atlas->white : &atlas->digits[asset - ASSET_COUNT - 1];
+
+        if (asset > ASSET_COUNT) {
+            w = GLYPH_WIDTH;
+            h = GLYPH_HEIGHT;
+        } else if (asset < ASSET_COUNT) {
+            const AssetPackEntry *entry = loader.pack.header ? &loader.pack.header->entries[asset] : NULL;
+            if (!entry || entry->width == 0) {
+                continue;
+            }
+            w = (int)entry->width;
+            h = (int)entry->height;
+        }
+        if (x + w > ATLAS_MAX_WIDTH) {
+            x = 0;
+            y += row_height + ATLAS_PADDING;
+            row_height = 0;
+        }
+        *rect = (SDL_Rect){x, y, w, h};
+        x += w + ATLAS_PADDING;
+        if (h > row_height) {
+            row_height = h;
+        }
+    }
+    return y + row_height;
+}
+
+// White where the glyph is set, transparent elsewhere, so a tint colours it
+static void upload_glyphs(Atlas *atlas) {
+    uint8_t pixels[GLYPH_WIDTH * GLYPH_HEIGHT * 4];
+
+    memset(pixels, 0xFF, sizeof(pixels));
+    for (int digit = 0; digit < 10; digit++) {
+        for (int row = 0; row < GLYPH_HEIGHT; row++) {
+            for (int col = 0; col < GLYPH_WIDTH; col++) {
+                int set = (glyph_rows[digit][row] >> (GLYPH_WIDTH - 1 - col)) & 1;
+                pixels[(row * GLYPH_WIDTH + col) * 4 + 3] = set ? 0xFF : 0x00;
+            }
+        }
+        SDL_UpdateTexture(atlas->texture, &atlas->digits[digit], pixels, GLYPH_WIDTH * 4);
+    }
+}
+
+// Claim images until none are left; pixels are published before the flag
+static int decode_thread(void *data) {
+    (void)data;
+    for (;;) {
+        int asset = SDL_AtomicAdd(&loader.next, 1);
+        if (asset >= ASSET_COUNT) {
+            break;
+        }
+
+        const AssetPackEntry *entry = &loader.pack.header->entries[asset];
+        if (entry->width > 0) {
+            uint8_t *pixels = malloc((size_t)entry->width * entry->height * 4);
+            if (pixels && !asset_pack_decode(&loader.pack, asset, pixels)) {
+                free(pixels);
+                pixels = NULL;
+            }
+            if (!pixels) {
+                char path[64];
+                asset_path(asset, path, sizeof(path));
+                fprintf(stderr, "Failed to decode %s from the asset pack\n", path);
+            }
+            loader.pixels[asset] = pixels;
+        }
+        SDL_AtomicSet(&loader.ready[asset], 1);
+    }
+    return 0;
+}
+
+static void stop_workers(void) {
+    SDL_AtomicSet(&loader.next, ASSET_COUNT);
+    for (int w = 0; w < loader.worker_count; w++) {
+        SDL_WaitThread(loader.workers[w], NULL);
+    }
+    loader.worker_count = 0;
+}
+
+int atlas_load(Atlas *atlas, SDL_Renderer *renderer, const char *pack_path) {
+    memset(atlas, 0, sizeof(*atlas));
+    memset(&loader, 0, sizeof(loader));
+    loader.start = SDL_GetPerformanceCounter();
+
+    // Without a pack the atlas holds only the white block for plain tiles
+    int have_pack = open_pack(pack_path);
+    int height = pack_layout(atlas);
+
+    atlas->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                       SDL_TEXTUREACCESS_STATIC, ATLAS_MAX_WIDTH, height);
+    if (!atlas->texture) {
+        fprintf(stderr, "Failed to create atlas texture: %s\n", SDL_GetError());
+        asset_pack_close(&loader.pack);
+        return 0;
+    }
+    atlas->width = ATLAS_MAX_WIDTH;
+    atlas->height = height;
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+
+    uint32_t white[ATLAS_WHITE_SIZE * ATLAS_WHITE_SIZE];
+    memset(white, 0xFF, sizeof(white));
+    SDL_UpdateTexture(atlas->texture, &atlas->white, white, ATLAS_WHITE_SIZE * 4);
+    upload_glyphs(atlas);
+    if (!have_pack) {
+        return 1;
+    }
+
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        if (loader.pack.header->entries[asset].width > 0) {
+            loader.waiting[asset] = SDL_TRUE;
+            atlas->pending++;
+        }
+    }
+
+    // Image rects stay empty (drawn plain) until atlas_poll() uploads them
+    int workers = SDL_GetCPUCount();
+    if (workers > ATLAS_MAX_WORKERS) {
+        workers = ATLAS_MAX_WORKERS;
+    }
+    for (int w = 0; w < workers; w++) {
+        SDL_Thread *thread = SDL_CreateThread(decode_thread, "assets", NULL);
+        if (thread) {
+            loader.workers[loader.worker_count++] = thread;
+        }
+    }
+    if (loader.worker_count == 0) {
+        decode_thread(NULL);
+    }
+    return 1;
+}
+
+// Upload the images decoded since the last call; returns how many
+int atlas_poll(Atlas *atlas) {
+    int uploaded = 0;
+
+    if (atlas->pending == 0) {
+        return 0;
+    }
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        if (!loader.waiting[asset] || !SDL_AtomicGet(&loader.ready[asset])) {
+            continue;
+        }
+        loader.waiting[asset] = SDL_FALSE;
+        atlas->pending--;
+        if (!loader.pixels[asset]) {
+            continue;
+        }
+
+        SDL_Rect rect = loader.rects[asset];
+        if (SDL_UpdateTexture(atlas->texture, &rect, loader.pixels[asset], rect.w * 4) == 0) {
+            if (asset < ASSET_NUMBER_COUNT) {
+                atlas->numbers[asset] = rect;
+            } else {
+                atlas->ui[asset - ASSET_NUMBER_COUNT] = rect;
+            }
+            uploaded++;
+        }
+        free(loader.pixels[asset]);
+        loader.pixels[asset] = NULL;
+    }
+
+    if (atlas->pending == 0) {
+        stop_workers();
+        asset_pack_close(&loader.pack);
+        printf("Loaded images in %.1f ms\n", (double)(SDL_GetPerformanceCounter() - loader.start) *
+                                             1000.0 / (double)SDL_GetPerformanceFrequency());
+    }
+    return uploaded;
+}
+
+void atlas_free(Atlas *atlas) {
+    stop_workers();
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        free(loader.pixels[asset]);
+        loader.pixels[asset] = NULL;
+        loader.waiting[asset] = SDL_FALSE;
+    }
+    asset_pack_close(&loader.pack);
+
+    if (atlas->texture) {
+        SDL_DestroyTexture(atlas->texture);
+    }
+    memset(atlas, 0, sizeof(*atlas));
+}
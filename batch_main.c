@@ -0,0 +1,376 @@
+/**
+ * Taquin - Headless Batch Solver
+ *
+ * Streams puzzles from a file or stdin, one board per line (tiles in
+ * row-major order separated by spaces, 0 for the empty cell), solves them on
+ * a pool of worker threads and writes one JSON object per puzzle to stdout,
+ * in input order. Only a fixed window of puzzles is in memory at a time, so
+ * inputs of any length stream through. With -s the workers take the puzzle
+ * with the highest heuristic estimate in the window first, so long solves
+ * start early instead of trailing at the end. Boards that need a pattern
+ * database (5x5) are reported unsupported when none is given with -p.
+ * No SDL required.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bitboard.h"
+#include "heuristic.h"
+#include "pdb.h"
+#include "solver.h"
+#include "transtable.h"
+
+// Longest accepted input line and puzzles in flight per worker
+#define BATCH_LINE_CHARS 256
+#define BATCH_SLOTS_PER_WORKER 16
+
+// Lines read and scored together when sorting hardest first
+#define BATCH_SCORE_GROUP 32
+
+typedef enum {
+    SLOT_PENDING,
+    SLOT_RUNNING,
+    SLOT_DONE
+} SlotState;
+
+typedef struct {
+    long line_number;
+    int valid;
+    PackedBoard board;
+    uint16_t estimate;  // Heuristic distance, when sorting hardest first
+    SolverResult result;
+    const char *error;  // Why the board was not solved, if known
+    double seconds;
+    SlotState state;
+} Slot;
+
+// Ring of puzzles: [written, read) are in flight, `pending` of them unclaimed
+typedef struct {
+    Slot *slots;
+    uint64_t window;
+    uint64_t written;
+    uint64_t read;
+    uint64_t pending;
+    int input_done;
+    int hardest_first;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    const PdbSet *pdb[PACKED_MAX_SIZE + 1];  // Pattern databases by board size
+    size_t table_bytes;  // Transposition table budget per worker, 0 for none
+} Batch;
+
+static const char move_letters[MOVE_COUNT] = {'L', 'R', 'U', 'D'};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Oldest unclaimed puzzle, or the one with the highest estimate
+// (called with the lock held and at least one puzzle pending)
+static Slot *claim_slot(Batch *batch) {
+    Slot *best = NULL;
+
+    for (uint64_t i = batch->written; i < batch->read; i++) {
+        Slot *slot = &batch->slots[i % batch->window];
+        if (slot->state != SLOT_PENDING) {
+            continue;
+        }
+        if (!batch->hardest_first) {
+            best = slot;
+            break;
+        }
+        if (!best || slot->estimate > best->estimate) {
+            best = slot;
+        }
+    }
+    best->state = SLOT_RUNNING;
+    batch->pending--;
+    return best;
+}
+
+static void *worker_main(void *arg) {
+    Batch *batch = arg;
+    TransTable table;
+    int has_table = batch->table_bytes > 0 && tt_init(&table, batch->table_bytes);
+
+    pthread_mutex_lock(&batch->lock);
+    for (;;) {
+        while (batch->pending == 0 && !batch->input_done) {
+            pthread_cond_wait(&batch->changed, &batch->lock);
+        }
+        if (batch->pending == 0) {
+            break;
+        }
+
+        Slot *slot = claim_slot(batch);
+        pthread_mutex_unlock(&batch->lock);
+
+        if (slot->valid) {
+            // Each puzzle is solved on one thread; parallelism comes from the pool
+            SolverConfig config = {0};
+            config.pdb = batch->pdb[slot->board.size];
+            config.threads = 1;
+            config.table = has_table ? &table : NULL;
+
+            double start = now_seconds();
+            if (slot->board.size >= SOLVER_PDB_MIN_SIZE && !config.pdb) {
+                memset(&slot->result, 0, sizeof(slot->result));
+                slot->result.status = SOLVER_UNSUPPORTED;
+                slot->error = "needs a pattern database for this size (-p)";
+            } else {
+                solver_solve_with(&slot->board, &config, &slot->result);
+            }
+            slot->seconds = now_seconds() - start;
+        }
+
+        pthread_mutex_lock(&batch->lock);
+        slot->state = SLOT_DONE;
+        pthread_cond_broadcast(&batch->changed);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    if (has_table) {
+        tt_free(&table);
+    }
+    return NULL;
+}
+
+static void write_slot(FILE *out, const Slot *slot) {
+    static const char *status_names[] = {"solved", "unsolvable", "unsupported", "cancelled"};
+
+    if (!slot->valid) {
+        fprintf(out, "{\"line\":%ld,\"status\":\"invalid\"}\n", slot->line_number);
+        return;
+    }
+
+    int cells = slot->board.size * slot->board.size;
+    fprintf(out, "{\"line\":%ld,\"board\":\"", slot->line_number);
+    for (int cell = 0; cell < cells; cell++) {
+        fprintf(out, cell ? " %d" : "%d", packed_get(&slot->board, cell));
+    }
+    fprintf(out, "\",\"status\":\"%s\"", status_names[slot->result.status]);
+    if (slot->result.status == SOLVER_SOLVED) {
+        fprintf(out, ",\"length\":%d,\"moves\":\"", slot->result.length);
+        for (int i = 0; i < slot->result.length; i++) {
+            fputc(move_letters[slot->result.moves[i]], out);
+        }
+        fputc('"', out);
+    }
+    if (slot->error) {
+        fprintf(out, ",\"error\":\"%s\"", slot->error);
+    }
+    fprintf(out, ",\"nodes\":%llu,\"ms\":%.3f}\n",
+            (unsigned long long)slot->result.nodes, slot->seconds * 1000.0);
+}
+
+// Write every finished puzzle at the front of the window
+// (called with the lock held; blocks until at least `keep` slots remain)
+static void flush_done(Batch *batch, FILE *out, uint64_t keep) {
+    while (batch->read - batch->written > keep) {
+        Slot *slot = &batch->slots[batch->written % batch->window];
+        if (slot->state != SLOT_DONE) {
+            pthread_cond_wait(&batch->changed, &batch->lock);
+            continue;
+        }
+        // The reader is the only thread that reuses slots, so the slot is
+        // stable while the lock is released for the write
+        pthread_mutex_unlock(&batch->lock);
+        write_slot(out, slot);
+        pthread_mutex_lock(&batch->lock);
+        batch->written++;
+    }
+}
+
+// Map a database unless one is already loaded for its board size
+static int add_pdb(Batch *batch, PdbSet *sets, int *set_count, const char *path) {
+    PdbSet *set = &sets[*set_count];
+
+    if (*set_count > PACKED_MAX_SIZE || !pdb_open(set, path)) {
+        return 0;
+    }
+    if (batch->pdb[set->size]) {
+        pdb_close(set);
+        return 1;
+    }
+    batch->pdb[set->size] = set;
+    (*set_count)++;
+    return 1;
+}
+
+static int usage(void) {
+    fprintf(stderr, "Usage: taquin-solve [-j threads] [-p pdb-file]... [-t table-mb] [-s] [input-file]\n");
+    fprintf(stderr, "  Reads one board per line (row-major tiles, 0 = empty) and writes\n");
+    fprintf(stderr, "  JSON lines; moves are the empty cell's directions (L, R, U, D).\n");
+    fprintf(stderr, "  Without -p, databases under data/ are used when present.\n");
+    fprintf(stderr, "  -t gives each worker a transposition table of that many MB (0: none).\n");
+    fprintf(stderr, "  -s solves the hardest-looking puzzles in the window first; output\n");
+    fprintf(stderr, "  stays in input order.\n");
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[]) {
+    Batch batch;
+    PdbSet pdb_sets[PACKED_MAX_SIZE + 1];
+    int pdb_count = 0;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *input_path = NULL;
+
+    memset(&batch, 0, sizeof(batch));
+    batch.table_bytes = TT_DEFAULT_BYTES;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            if (!add_pdb(&batch, pdb_sets, &pdb_count, argv[++i])) {
+                fprintf(stderr, "Cannot load pattern database %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            batch.table_bytes = (size_t)atol(argv[++i]) << 20;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            batch.hardest_first = 1;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            return usage();
+        } else {
+            input_path = argv[i];
+        }
+    }
+    if (pdb_count == 0) {
+        static const char *defaults[] = {
+            "data/pdb-4x4-7-8.bin", "data/pdb-4x4-6-6-3.bin", "data/pdb-5x5-6-6-6-6.bin"
+        };
+        for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+            add_pdb(&batch, pdb_sets, &pdb_count, defaults[i]);
+        }
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    FILE *in = input_path ? fopen(input_path, "r") : stdin;
+    if (!in) {
+        fprintf(stderr, "Cannot open %s\n", input_path);
+        return EXIT_FAILURE;
+    }
+
+    batch.window = (uint64_t)threads * BATCH_SLOTS_PER_WORKER;
+    batch.slots = calloc((size_t)batch.window, sizeof(Slot));
+    pthread_t *workers = calloc((size_t)threads, sizeof(pthread_t));
+    if (!batch.slots || !workers) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.changed, NULL);
+
+    // Run with the workers the system allows; only those are joined
+    int started = 0;
+    while (started < threads && pthread_create(&workers[started], NULL, worker_main, &batch) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        fprintf(stderr, "Cannot start a worker thread\n");
+        return EXIT_FAILURE;
+    }
+    if (started < threads) {
+        fprintf(stderr, "Started %d of %d worker threads\n", started, threads);
+    }
+
+    // Lines are parsed a group at a time and scored with one batch call;
+    // without -s each line is handed out as soon as it is read
+    Slot group[BATCH_SCORE_GROUP];
+    PackedBoard boards[BATCH_SCORE_GROUP];
+    StateScore scores[BATCH_SCORE_GROUP];
+    int group_size = batch.hardest_first ? BATCH_SCORE_GROUP : 1;
+    int grouped = 0;
+    char line[BATCH_LINE_CHARS];
+    long line_number = 0;
+    int more = 1;
+    while (more) {
+        more = fgets(line, sizeof(line), in) != NULL;
+        if (more) {
+            line_number++;
+
+            // Overlong lines are reported once and skipped to their end
+            size_t length = strlen(line);
+            int truncated = length == sizeof(line) - 1 && line[length - 1] != '\n';
+            if (truncated) {
+                int c;
+                while ((c = fgetc(in)) != EOF && c != '\n') {
+                }
+            }
+
+            const char *text = line + strspn(line, " \t\r\n");
+            if (!truncated && (*text == '\0' || *text == '#')) {
+                continue;
+            }
+
+            Slot *slot = &group[grouped++];
+            memset(slot, 0, sizeof(*slot));
+            slot->line_number = line_number;
+            int consumed = truncated ? 0 : packed_parse(&slot->board, text);
+            slot->valid = consumed > 0 && text[consumed + strspn(text + consumed, " \t\r\n")] == '\0';
+            slot->state = SLOT_PENDING;
+            if (grouped < group_size) {
+                continue;
+            }
+        }
+
+        if (batch.hardest_first) {
+            int valid = 0;
+            for (int i = 0; i < grouped; i++) {
+                if (group[i].valid) {
+                    boards[valid++] = group[i].board;
+                }
+            }
+            if (heuristic_score(boards, (size_t)valid, scores)) {
+                valid = 0;
+                for (int i = 0; i < grouped; i++) {
+                    if (group[i].valid) {
+                        group[i].estimate = scores[valid++].total;
+                    }
+                }
+            }
+        }
+
+        pthread_mutex_lock(&batch.lock);
+        for (int i = 0; i < grouped; i++) {
+            flush_done(&batch, stdout, batch.window - 1);
+            batch.slots[batch.read % batch.window] = group[i];
+            batch.read++;
+            batch.pending++;
+            pthread_cond_broadcast(&batch.changed);
+        }
+        pthread_mutex_unlock(&batch.lock);
+        grouped = 0;
+    }
+
+    pthread_mutex_lock(&batch.lock);
+    batch.input_done = 1;
+    pthread_cond_broadcast(&batch.changed);
+    flush_done(&batch, stdout, 0);
+    pthread_mutex_unlock(&batch.lock);
+
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+    for (int i = 0; i < pdb_count; i++) {
+        pdb_close(&pdb_sets[i]);
+    }
+    pthread_cond_destroy(&batch.changed);
+    pthread_mutex_destroy(&batch.lock);
+    free(workers);
+    free(batch.slots);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,1164 @@
+/**
+ * Taquin - Solver Benchmarks
+ *
+ * Headless microbenchmarks for the solver library (no SDL required).
+ * Run without arguments for every benchmark, or name one to run it alone;
+ * any further arguments go to that benchmark (scaling takes a thread count,
+ * boardgen a board count, moves a move count, assets a round count, bidir a
+ * 5x5 board count and a weight in percent, reduce a board count per size,
+ * ttable a table budget in MB and a thread count, heuristic a board count
+ * per size, arena a thread count and a 5x5 board count, diskbfs a 4x4 depth
+ * and a memory budget in MB, profile a timer count in millions and a thread
+ * count).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "arena.h"
+#include "assetpack.h"
+#include "bitboard.h"
+#include "board.h"
+#include "boardgen.h"
+#include "diskbfs.h"
+#include "disttable.h"
+#include "heuristic.h"
+#include "pdb.h"
+#include "profile.h"
+#include "rank.h"
+#include "reduce.h"
+#include "solver.h"
+#include "transtable.h"
+
+// Fixed 4x4 instance set (random solvable permutations, 46-58 moves)
+static const char *instances_4x4[] = {
+    "4 12 15 6 10 8 0 7 9 3 1 14 5 11 13 2",
+    "7 15 14 2 11 6 3 0 1 12 5 10 13 8 4 9",
+    "13 2 15 4 8 7 0 11 12 1 10 9 3 6 5 14",
+    "11 9 14 1 4 5 13 3 12 6 7 15 8 2 10 0",
+    "9 15 11 8 0 3 14 10 1 12 5 2 6 7 13 4",
+    "6 2 9 11 8 4 5 3 15 0 7 13 12 14 1 10",
+    "14 13 9 7 4 3 0 2 8 6 10 1 15 12 11 5",
+    "9 11 8 6 13 14 4 10 3 1 12 5 15 7 2 0",
+    "14 5 9 6 0 7 10 3 12 8 15 4 2 13 11 1",
+    "8 13 10 3 7 4 15 0 2 1 14 6 5 12 9 11",
+    "8 13 1 3 5 12 11 9 7 15 14 6 4 0 10 2",
+    "3 4 11 9 8 13 6 12 0 7 15 14 2 10 1 5"
+};
+#define INSTANCE_COUNT (int)(sizeof(instances_4x4) / sizeof(instances_4x4[0]))
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Pattern database used by the pdb benchmark
+#define BENCH_PDB_PATH "data/pdb-4x4-6-6-3.bin"
+
+// Single-threaded IDA* throughput over the fixed instance set
+static int run_instances(const char *title, const SolverConfig *config) {
+    uint64_t total_nodes = 0;
+    double total_time = 0.0;
+
+    printf("== %s ==\n", title);
+    for (int i = 0; i < INSTANCE_COUNT; i++) {
+        PackedBoard board;
+        SolverResult result;
+
+        if (!packed_parse(&board, instances_4x4[i])) {
+            fprintf(stderr, "Bad instance %d\n", i);
+            return 0;
+        }
+
+        double start = now_seconds();
+        int solved = solver_solve_with(&board, config, &result);
+        double elapsed = now_seconds() - start;
+
+        if (!solved) {
+            fprintf(stderr, "Instance %d not solved\n", i);
+            return 0;
+        }
+
+        total_nodes += result.nodes;
+        total_time += elapsed;
+        printf("  #%-2d %3d moves %12llu nodes %8.3f s\n", i, result.length,
+               (unsigned long long)result.nodes, elapsed);
+    }
+
+    printf("  total %llu nodes in %.3f s: %.2f Mnodes/s\n\n",
+           (unsigned long long)total_nodes, total_time,
+           total_time > 0 ? (double)total_nodes / total_time / 1e6 : 0.0);
+    return 1;
+}
+
+static int bench_solver(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    return run_instances("solver: IDA* (Manhattan + linear conflict), 1 thread", NULL);
+}
+
+static int bench_pdb(int argc, char *argv[]) {
+    PdbSet pdb;
+    SolverConfig config = {0};
+
+    (void)argc;
+    (void)argv;
+    if (!pdb_open(&pdb, BENCH_PDB_PATH)) {
+        printf("== pdb: skipped, %s missing (run make tables) ==\n\n", BENCH_PDB_PATH);
+        return 1;
+    }
+    config.pdb = &pdb;
+    int ok = run_instances("pdb: IDA* (6-6-3 additive pattern databases), 1 thread", &config);
+    pdb_close(&pdb);
+    return ok;
+}
+
+// Wall time to solve the whole instance set with the given config
+static double time_instances(const SolverConfig *config, int *lengths) {
+    double start = now_seconds();
+
+    for (int i = 0; i < INSTANCE_COUNT; i++) {
+        PackedBoard board;
+        SolverResult result;
+
+        packed_parse(&board, instances_4x4[i]);
+        if (!solver_solve_with(&board, config, &result)) {
+            return -1.0;
+        }
+        lengths[i] = result.length;
+    }
+    return now_seconds() - start;
+}
+
+// Parallel IDA* speedup from 1 to N threads (default: online CPUs)
+static int bench_scaling(int argc, char *argv[]) {
+    PdbSet pdb;
+    SolverConfig config = {0};
+    int max_threads = argc > 0 ? atoi(argv[0]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int serial_lengths[INSTANCE_COUNT];
+    int lengths[INSTANCE_COUNT];
+    double serial_time = 0.0;
+    int ok = 1;
+
+    if (max_threads < 1) {
+        max_threads = 1;
+    }
+    if (pdb_open(&pdb, BENCH_PDB_PATH)) {
+        config.pdb = &pdb;
+    }
+
+    printf("== scaling: parallel IDA* (%s), 1-%d threads ==\n",
+           config.pdb ? "6-6-3 pattern databases" : "Manhattan + linear conflict", max_threads);
+    for (int threads = 1; ok && threads <= max_threads;
+         threads = (threads * 2 > max_threads && threads < max_threads) ? max_threads : threads * 2) {
+        config.threads = threads;
+        double elapsed = time_instances(&config, threads == 1 ? serial_lengths : lengths);
+        if (elapsed < 0) {
+            fprintf(stderr, "Solve failed with %d threads\n", threads);
+            ok = 0;
+            break;
+        }
+        if (threads == 1) {
+            serial_time = elapsed;
+        } else if (memcmp(lengths, serial_lengths, sizeof(lengths)) != 0) {
+            fprintf(stderr, "Solution lengths differ with %d threads\n", threads);
+            ok = 0;
+        }
+        printf("  %2d threads %8.3f s  speedup %.2fx\n", threads, elapsed,
+               elapsed > 0 ? serial_time / elapsed : 0.0);
+    }
+    printf("\n");
+
+    if (config.pdb) {
+        pdb_close(&pdb);
+    }
+    return ok;
+}
+
+// Bulk generation rate of uniformly random solvable boards, per size
+static int bench_boardgen(int argc, char *argv[]) {
+    size_t count = argc > 0 ? (size_t)atol(argv[0]) : 4000000;
+    PackedBoard *boards = malloc(count * sizeof(PackedBoard));
+    Rng rng;
+
+    if (!boards) {
+        fprintf(stderr, "Out of memory\n");
+        return 0;
+    }
+    rng_seed(&rng, 1);
+
+    printf("== boardgen: uniform solvable boards, %zu per size ==\n", count);
+    int ok = 1;
+    for (int size = 3; size <= PACKED_MAX_SIZE; size++) {
+        double start = now_seconds();
+        boardgen_bulk(boards, count, size, &rng);
+        double elapsed = now_seconds() - start;
+
+        // Spot-check the parity repair
+        for (size_t i = 0; i < count; i += 997) {
+            if (!solver_is_solvable(&boards[i])) {
+                fprintf(stderr, "Unsolvable %dx%d board generated\n", size, size);
+                ok = 0;
+            }
+        }
+        printf("  %dx%d %8.3f s  %.2f Mboards/s\n", size, size, elapsed,
+               elapsed > 0 ? (double)count / elapsed / 1e6 : 0.0);
+    }
+
+    // Runtime-sized boards, fewer of them as they grow
+    static const int large_sizes[] = {8, 16, BOARD_MAX_SIZE};
+    Board board = {0};
+    for (int i = 0; ok && i < 3; i++) {
+        int size = large_sizes[i];
+        size_t large_count = count / (size_t)(size * size / 16);
+        double start = now_seconds();
+        for (size_t n = 0; n < large_count; n++) {
+            boardgen_board(&board, size, &rng);
+        }
+        double elapsed = now_seconds() - start;
+        if (!board_is_solvable(&board)) {
+            fprintf(stderr, "Unsolvable %dx%d board generated\n", size, size);
+            ok = 0;
+        }
+        printf("  %dx%d %8.3f s  %.2f Mboards/s (%zu boards)\n", size, size, elapsed,
+               elapsed > 0 ? (double)large_count / elapsed / 1e6 : 0.0, large_count);
+    }
+    board_free(&board);
+    printf("\n");
+
+    free(boards);
+    return ok;
+}
+
+// Solved check by scanning every cell, as before the running counts
+static int scan_solved(const Board *board) {
+    for (int cell = 0; cell < board->cells; cell++) {
+        if (board->tiles[cell] != board_goal(board, cell)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Replay a recorded game with a win check after every move: a full scan
+// against the counts kept by board_slide(), which must end equal to a
+// recount from scratch. The game is short random walks away from the goal
+// and back, the end of a solve over and over: the disorder stays near the
+// empty cell's corner, so a scan finds no early mismatch.
+#define MOVES_WALK 64
+
+static int bench_moves(int argc, char *argv[]) {
+    size_t count = argc > 0 ? (size_t)atol(argv[0]) : 2000000;
+    uint16_t *cells = malloc(count * sizeof(uint16_t));
+    static const int sizes[] = {4, 16, BOARD_MAX_SIZE};
+    Board start = {0}, board = {0};
+    Rng rng;
+    int ok = 1;
+
+    if (!cells) {
+        fprintf(stderr, "Out of memory\n");
+        return 0;
+    }
+    count -= count % (2 * MOVES_WALK);
+    rng_seed(&rng, 1);
+
+    printf("== moves: win check per replayed move, %zu moves per size ==\n", count);
+    for (int i = 0; ok && i < 3; i++) {
+        int size = sizes[i];
+        board_init(&start, size);
+
+        // Record the walks: each move is the cell of a random neighbour of the
+        // empty cell, and the way back slides the cells it came from
+        uint16_t trail[MOVES_WALK];
+        board_copy(&board, &start);
+        for (size_t n = 0; n < count; n++) {
+            int step = (int)(n % (2 * MOVES_WALK));
+            int x = board.empty % size, y = board.empty / size;
+            int cell = -1;
+            if (step >= MOVES_WALK) {
+                cell = trail[2 * MOVES_WALK - 1 - step];
+            }
+            while (cell < 0) {
+                switch (rng_below(&rng, 4)) {
+                    case 0: cell = x > 0 ? board.empty - 1 : -1; break;
+                    case 1: cell = x < size - 1 ? board.empty + 1 : -1; break;
+                    case 2: cell = y > 0 ? board.empty - size : -1; break;
+                    default: cell = y < size - 1 ? board.empty + size : -1; break;
+                }
+            }
+            if (step < MOVES_WALK) {
+                trail[step] = (uint16_t)board.empty;
+            }
+            cells[n] = (uint16_t)cell;
+            board_slide(&board, cell);
+        }
+
+        size_t wins[2] = {0, 0};
+        double elapsed[2];
+        for (int counted = 0; counted < 2; counted++) {
+            board_copy(&board, &start);
+            double begin = now_seconds();
+            for (size_t n = 0; n < count; n++) {
+                board_slide(&board, cells[n]);
+                wins[counted] += (size_t)(counted ? board_is_solved(&board) : scan_solved(&board));
+            }
+            elapsed[counted] = now_seconds() - begin;
+        }
+
+        Board recount = {0};
+        board_copy(&recount, &board);
+        board_recount(&recount);
+        if (wins[0] != wins[1] || wins[1] == 0 || !board_is_solved(&board) ||
+            recount.misplaced != board.misplaced || recount.manhattan != board.manhattan) {
+            fprintf(stderr, "%dx%d running counts disagree with a recount\n", size, size);
+            ok = 0;
+        }
+        board_free(&recount);
+
+        printf("  %2dx%-2d scan %7.3f s  counted %7.3f s  %6.1fx  (%zu solved positions)\n",
+               size, size, elapsed[0], elapsed[1],
+               elapsed[1] > 0 ? elapsed[0] / elapsed[1] : 0.0, wins[1]);
+    }
+    printf("\n");
+
+    board_free(&start);
+    board_free(&board);
+    free(cells);
+    return ok;
+}
+
+// Rank/unrank round trips over every 3x3 state and every 6-tile 4x4 placement
+static int bench_rank(int argc, char *argv[]) {
+    uint64_t states = rank_count(9, 9);
+    uint64_t solvable = 0;
+    uint64_t checksum = 0;
+    int ok = 1;
+
+    (void)argc;
+    (void)argv;
+    printf("== rank: permutation ranking round trips ==\n");
+
+    double start = now_seconds();
+    for (uint64_t r = 0; r < states; r++) {
+        PackedBoard board;
+        if (!unrank_board(&board, 3, r) || rank_board(&board) != r) {
+            fprintf(stderr, "3x3 rank %llu does not round-trip\n", (unsigned long long)r);
+            ok = 0;
+            break;
+        }
+        solvable += (uint64_t)solver_is_solvable(&board);
+    }
+    double elapsed = now_seconds() - start;
+    if (solvable != states / 2) {
+        fprintf(stderr, "%llu solvable 3x3 states, expected %llu\n",
+                (unsigned long long)solvable, (unsigned long long)(states / 2));
+        ok = 0;
+    }
+    printf("  3x3 boards     %9llu states %8.3f s\n", (unsigned long long)states, elapsed);
+
+    start = now_seconds();
+    for (uint64_t r = 0; ok && r < states / 2; r++) {
+        PackedBoard board;
+        if (!unrank_solvable(&board, 3, r) || !solver_is_solvable(&board) ||
+            rank_solvable(&board) != r) {
+            fprintf(stderr, "3x3 solvable rank %llu does not round-trip\n", (unsigned long long)r);
+            ok = 0;
+        }
+    }
+    elapsed = now_seconds() - start;
+    printf("  3x3 solvable   %9llu states %8.3f s\n", (unsigned long long)(states / 2), elapsed);
+
+    uint64_t placements = rank_count(16, 6);
+    start = now_seconds();
+    for (uint64_t r = 0; ok && r < placements; r++) {
+        uint8_t cells[6];
+        unrank_partial(r, cells, 6, 16);
+        uint64_t back = rank_partial(cells, 6, 16);
+        checksum += back;
+        if (back != r) {
+            fprintf(stderr, "4x4 placement %llu does not round-trip\n", (unsigned long long)r);
+            ok = 0;
+        }
+    }
+    elapsed = now_seconds() - start;
+    printf("  4x4 6 of 16    %9llu states %8.3f s  %.1f Mtrips/s (checksum %llx)\n\n",
+           (unsigned long long)placements, elapsed,
+           elapsed > 0 ? (double)placements / elapsed / 1e6 : 0.0, (unsigned long long)checksum);
+    return ok;
+}
+
+// Image pack produced by `make assets`
+#define BENCH_ASSET_PACK "data/assets.pack"
+#define BENCH_ASSET_THREADS 4
+
+// Evict a file from the page cache where the OS supports it, so the next
+// read comes from disk as on a cold start
+static void drop_cached(const char *path) {
+#ifdef POSIX_FADV_DONTNEED
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+typedef struct {
+    AssetPack *pack;
+    int *next;
+    int failed;
+} DecodeWorker;
+
+static void *decode_worker(void *arg) {
+    DecodeWorker *worker = arg;
+    uint8_t *rgba = malloc((size_t)ASSET_SCREEN_WIDTH * ASSET_SCREEN_HEIGHT * 4);
+
+    worker->failed = !rgba;
+    for (int asset; rgba && (asset = __atomic_fetch_add(worker->next, 1, __ATOMIC_RELAXED)) < ASSET_COUNT;) {
+        if (worker->pack->header->entries[asset].width && !asset_pack_decode(worker->pack, asset, rgba)) {
+            worker->failed = 1;
+        }
+    }
+    free(rgba);
+    return NULL;
+}
+
+// Map the pack and decode every image on the given number of threads
+static int load_pack(int threads) {
+    pthread_t handles[BENCH_ASSET_THREADS];
+    DecodeWorker workers[BENCH_ASSET_THREADS];
+    AssetPack pack;
+    int next = 0, started = 0, ok = 1;
+
+    if (!asset_pack_open(&pack, BENCH_ASSET_PACK)) {
+        return 0;
+    }
+    for (int t = 0; t < threads; t++) {
+        workers[t] = (DecodeWorker){&pack, &next, 0};
+        if (t > 0 && pthread_create(&handles[t], NULL, decode_worker, &workers[t]) == 0) {
+            started++;
+        }
+    }
+    decode_worker(&workers[0]);
+    for (int t = 1; t <= started; t++) {
+        pthread_join(handles[t], NULL);
+    }
+    for (int t = 0; t <= started; t++) {
+        ok = ok && !workers[t].failed;
+    }
+    asset_pack_close(&pack);
+    return ok;
+}
+
+// The previous startup path: read, decode and scale each BMP in turn
+static int load_bitmaps(void) {
+    uint8_t *rgb = malloc((size_t)ASSET_SCREEN_WIDTH * ASSET_SCREEN_HEIGHT * 3);
+    for (int asset = 0; rgb && asset < ASSET_COUNT; asset++) {
+        char path[64];
+        int width, height;
+        asset_path(asset, path, sizeof(path));
+        asset_size(asset, &width, &height);
+        asset_load_bmp(path, width, height, rgb);
+    }
+    free(rgb);
+    return rgb != NULL;
+}
+
+static void drop_asset_caches(void) {
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        char path[64];
+        asset_path(asset, path, sizeof(path));
+        drop_cached(path);
+    }
+    drop_cached(BENCH_ASSET_PACK);
+}
+
+// Startup image loading, before textures are uploaded: the per-file BMP
+// path against the mapped pack decoded on one and on several threads, each
+// with the files evicted from the page cache first and then warm
+static int bench_assets(int argc, char *argv[]) {
+    int rounds = argc > 0 ? atoi(argv[0]) : 5;
+    AssetPack pack;
+
+    if (!asset_pack_open(&pack, BENCH_ASSET_PACK)) {
+        fprintf(stderr, "Missing %s (run make assets)\n", BENCH_ASSET_PACK);
+        return 0;
+    }
+    size_t pack_bytes = pack.file.size;
+    asset_pack_close(&pack);
+
+    uint64_t bitmap_bytes = 0;
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        char path[64];
+        FILE *file;
+        asset_path(asset, path, sizeof(path));
+        if ((file = fopen(path, "rb")) != NULL) {
+            fseek(file, 0, SEEK_END);
+            bitmap_bytes += (uint64_t)ftell(file);
+            fclose(file);
+        }
+    }
+
+    printf("== assets: startup image loading, best of %d ==\n", rounds);
+    printf("  bitmaps %.1f MB, pack %.1f MB\n", (double)bitmap_bytes / 1e6, (double)pack_bytes / 1e6);
+    int ok = 1;
+    for (int cold = 1; cold >= 0; cold--) {
+        double best[3] = {1e9, 1e9, 1e9};
+        for (int round = 0; round < rounds; round++) {
+            for (int method = 0; method < 3; method++) {
+                if (cold) {
+                    drop_asset_caches();
+                }
+                double start = now_seconds();
+                ok = (method == 0 ? load_bitmaps() : load_pack(method == 1 ? 1 : BENCH_ASSET_THREADS)) && ok;
+                double elapsed = now_seconds() - start;
+                if (elapsed < best[method]) {
+                    best[method] = elapsed;
+                }
+            }
+        }
+        printf("  %-5s bitmaps %8.2f ms   pack %8.2f ms   pack x%d %8.2f ms\n",
+               cold ? "cold" : "warm", best[0] * 1e3, best[1] * 1e3, BENCH_ASSET_THREADS, best[2] * 1e3);
+    }
+    printf("\n");
+    return ok;
+}
+
+// Bidirectional engine against IDA* on the same boards: the 4x4 set and 5x5
+// boards scrambled by short random walks, both optimal, then the weighted
+// mode on uniformly random 5x5 boards, far beyond what IDA* can finish
+#define BIDIR_WALK 80
+
+static double solve_timed(const PackedBoard *board, const SolverConfig *config,
+                          SolverResult *result) {
+    double start = now_seconds();
+    if (!solver_solve_with(board, config, result)) {
+        return -1.0;
+    }
+    return now_seconds() - start;
+}
+
+// Both engines on one board; 0 if either fails or they disagree on length
+static int compare_engines(int index, const PackedBoard *board, double *totals) {
+    SolverConfig bidir = {0};
+    SolverResult ida_result, bidir_result;
+
+    bidir.engine = SOLVER_ENGINE_BIDIRECTIONAL;
+    double ida_time = solve_timed(board, NULL, &ida_result);
+    double bidir_time = solve_timed(board, &bidir, &bidir_result);
+    if (ida_time < 0 || bidir_time < 0 || ida_result.length != bidir_result.length) {
+        fprintf(stderr, "Instance %d: engines disagree\n", index);
+        return 0;
+    }
+    totals[0] += ida_time;
+    totals[1] += bidir_time;
+    printf("  #%-2d %3d moves  IDA* %12llu nodes %8.3f s  bidirectional %10llu nodes %8.3f s\n",
+           index, ida_result.length, (unsigned long long)ida_result.nodes, ida_time,
+           (unsigned long long)bidir_result.nodes, bidir_time);
+    return 1;
+}
+
+static int bench_bidir(int argc, char *argv[]) {
+    int count = argc > 0 ? atoi(argv[0]) : 6;
+    int weight = argc > 1 ? atoi(argv[1]) : 200;
+    double totals[2] = {0.0, 0.0};
+    Rng rng;
+    int ok = 1;
+
+    printf("== bidir: optimal bidirectional vs IDA*, 4x4 set ==\n");
+    for (int i = 0; ok && i < INSTANCE_COUNT; i++) {
+        PackedBoard board;
+        packed_parse(&board, instances_4x4[i]);
+        ok = compare_engines(i, &board, totals);
+    }
+    printf("  total IDA* %.3f s, bidirectional %.3f s\n\n", totals[0], totals[1]);
+
+    rng_seed(&rng, 1);
+    totals[0] = totals[1] = 0.0;
+    printf("== bidir: optimal bidirectional vs IDA*, 5x5 after %d-move walks ==\n", BIDIR_WALK);
+    for (int i = 0; ok && i < count; i++) {
+        PackedBoard board;
+        int prev = -1;
+        packed_init(&board, 5);
+        for (int step = 0; step < BIDIR_WALK; step++) {
+            int dir;
+            do {
+                dir = (int)rng_below(&rng, MOVE_COUNT);
+            } while (dir == (prev ^ 1) || !packed_move(&board, dir));
+            prev = dir;
+        }
+        ok = compare_engines(i, &board, totals);
+    }
+    printf("  total IDA* %.3f s, bidirectional %.3f s\n\n", totals[0], totals[1]);
+
+    SolverConfig config = {0};
+    config.engine = SOLVER_ENGINE_BIDIRECTIONAL;
+    config.weight = weight;
+    config.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    double total_time = 0.0, worst = 0.0, total_excess = 0.0;
+    printf("== bidir: weight %d%%, %d threads, uniform random 5x5 (IDA*: hours each) ==\n",
+           weight, config.threads);
+    for (int i = 0; ok && i < count; i++) {
+        PackedBoard board;
+        SolverResult result;
+        boardgen_random(&board, 5, &rng);
+        double elapsed = solve_timed(&board, &config, &result);
+        if (elapsed < 0) {
+            fprintf(stderr, "Instance %d not solved\n", i);
+            ok = 0;
+            break;
+        }
+
+        // Length over the heuristic, which never exceeds the optimum
+        int bound = solver_heuristic(&board);
+        total_time += elapsed;
+        total_excess += (double)result.length / bound;
+        worst = elapsed > worst ? elapsed : worst;
+        printf("  #%-2d %3d moves (lower bound %3d, x%.2f) %10llu nodes %8.3f s\n", i,
+               result.length, bound, (double)result.length / bound,
+               (unsigned long long)result.nodes, elapsed);
+    }
+    if (ok && count > 0) {
+        printf("  mean %.3f s, worst %.3f s, mean length x%.2f the lower bound\n",
+               total_time / count, worst, total_excess / count);
+    }
+    printf("\n");
+    return ok;
+}
+
+// Reduction solver on random boards of every size, plain and polished:
+// length against the lower bound and latency, each plan replayed to check
+// it solves its board; then the polished plans on the 4x4 set against the
+// optimum
+static double reduce_timed(const Board *board, int polish, MovePlan *plan) {
+    double start = now_seconds();
+    Board check = {0};
+    int ok = reduce_solve(board, polish, NULL, plan);
+    double elapsed = now_seconds() - start;
+
+    ok = ok && board_copy(&check, board);
+    for (size_t i = 0; ok && i < plan->length; i++) {
+        int cell = board_neighbor(&check, plan->moves[i]);
+        ok = cell >= 0 && board_slide(&check, cell) >= 0;
+    }
+    ok = ok && board_is_solved(&check);
+    board_free(&check);
+    return ok ? elapsed : -1.0;
+}
+
+static int bench_reduce(int argc, char *argv[]) {
+    static const int sizes[] = {3, 4, 5, 8, 16, BOARD_MAX_SIZE};
+    int count = argc > 0 ? atoi(argv[0]) : 100;
+    Board board = {0};
+    MovePlan plan = {0};
+    Rng rng;
+    int ok = 1;
+
+    rng_seed(&rng, 1);
+    printf("== reduce: row/column reduction, %d uniform random boards per size ==\n", count);
+    printf("  size   plain: length  x bound  mean ms  worst ms   polished: length  x bound  mean ms  worst ms\n");
+    for (int s = 0; ok && s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+        double length[2] = {0.0, 0.0}, excess[2] = {0.0, 0.0};
+        double total[2] = {0.0, 0.0}, worst[2] = {0.0, 0.0};
+
+        for (int i = 0; ok && i < count; i++) {
+            ok = boardgen_board(&board, sizes[s], &rng);
+            for (int polish = 0; ok && polish < 2; polish++) {
+                double elapsed = reduce_timed(&board, polish, &plan);
+                if (elapsed < 0) {
+                    fprintf(stderr, "%dx%d board %d not solved\n", sizes[s], sizes[s], i);
+                    ok = 0;
+                    break;
+                }
+                length[polish] += (double)plan.length;
+                excess[polish] += (double)plan.length / (plan.lower_bound > 0 ? plan.lower_bound : 1);
+                total[polish] += elapsed;
+                worst[polish] = elapsed > worst[polish] ? elapsed : worst[polish];
+            }
+        }
+        if (ok && count > 0) {
+            printf("  %2dx%-2d %14.1f %8.2f %8.2f %9.2f %18.1f %8.2f %8.2f %9.2f\n", sizes[s], sizes[s],
+                   length[0] / count, excess[0] / count, total[0] * 1e3 / count, worst[0] * 1e3,
+                   length[1] / count, excess[1] / count, total[1] * 1e3 / count, worst[1] * 1e3);
+        }
+    }
+
+    int total_optimal = 0;
+    size_t total_polished = 0;
+    printf("\n== reduce: polished against optimal, 4x4 set ==\n");
+    for (int i = 0; ok && i < INSTANCE_COUNT; i++) {
+        PackedBoard packed;
+        SolverResult result;
+
+        packed_parse(&packed, instances_4x4[i]);
+        ok = board_from_packed(&board, &packed) && solver_solve(&packed, &result) &&
+             reduce_timed(&board, 1, &plan) >= 0;
+        if (!ok) {
+            fprintf(stderr, "Instance %d not solved\n", i);
+            break;
+        }
+        total_optimal += result.length;
+        total_polished += plan.length;
+        printf("  #%-2d optimal %3d  polished %3zu (x%.2f)\n", i, result.length, plan.length,
+               (double)plan.length / result.length);
+    }
+    if (ok) {
+        printf("  total optimal %d, polished %zu (x%.2f)\n", total_optimal, total_polished,
+               (double)total_polished / total_optimal);
+    }
+    printf("\n");
+
+    move_plan_free(&plan);
+    board_free(&board);
+    return ok;
+}
+
+// IDA* on the 4x4 set with and without a transposition table: expanded
+// nodes, time and table hit rate, with the Manhattan heuristic and then the
+// pattern databases when present; both must find the same lengths
+static int compare_table(const char *title, SolverConfig *config, size_t budget) {
+    TransTable table;
+    int plain_lengths[INSTANCE_COUNT];
+    uint64_t totals[2] = {0, 0};
+    double times[2] = {0.0, 0.0};
+
+    if (!tt_init(&table, budget)) {
+        fprintf(stderr, "Out of memory\n");
+        return 0;
+    }
+    printf("== ttable: %s, %zu MB table, %d thread(s) ==\n", title, table.bytes >> 20,
+           config->threads ? config->threads : 1);
+    for (int i = 0; i < INSTANCE_COUNT; i++) {
+        PackedBoard board;
+        SolverResult plain, tabled;
+
+        packed_parse(&board, instances_4x4[i]);
+        config->table = NULL;
+        double plain_time = solve_timed(&board, config, &plain);
+        config->table = &table;
+        double tabled_time = solve_timed(&board, config, &tabled);
+        if (plain_time < 0 || tabled_time < 0 || plain.length != tabled.length) {
+            fprintf(stderr, "Instance %d: lengths differ with the table\n", i);
+            tt_free(&table);
+            return 0;
+        }
+        plain_lengths[i] = plain.length;
+        totals[0] += plain.nodes;
+        totals[1] += tabled.nodes;
+        times[0] += plain_time;
+        times[1] += tabled_time;
+        printf("  #%-2d %2d moves  %10llu nodes %7.3f s  table %10llu nodes %7.3f s (-%.0f%%)\n",
+               i, plain_lengths[i], (unsigned long long)plain.nodes, plain_time,
+               (unsigned long long)tabled.nodes, tabled_time,
+               100.0 - 100.0 * (double)tabled.nodes / (double)plain.nodes);
+    }
+    printf("  total %llu nodes %.3f s, table %llu nodes %.3f s (-%.0f%% nodes)\n",
+           (unsigned long long)totals[0], times[0], (unsigned long long)totals[1], times[1],
+           100.0 - 100.0 * (double)totals[1] / (double)totals[0]);
+    printf("  %llu probes, %.1f%% cut a subtree, %llu stores\n\n",
+           (unsigned long long)table.stats.probes,
+           table.stats.probes ? 100.0 * (double)table.stats.hits / (double)table.stats.probes : 0.0,
+           (unsigned long long)table.stats.stores);
+    tt_free(&table);
+    return 1;
+}
+
+static int bench_ttable(int argc, char *argv[]) {
+    size_t budget = argc > 0 ? (size_t)atol(argv[0]) << 20 : TT_DEFAULT_BYTES;
+    SolverConfig config = {0};
+    PdbSet pdb;
+
+    config.threads = argc > 1 ? atoi(argv[1]) : 1;
+    if (!compare_table("IDA* (Manhattan + linear conflicts)", &config, budget)) {
+        return 0;
+    }
+    if (!pdb_open(&pdb, BENCH_PDB_PATH)) {
+        printf("== ttable: pattern databases skipped, %s missing (run make tables) ==\n\n",
+               BENCH_PDB_PATH);
+        return 1;
+    }
+    config.pdb = &pdb;
+    int ok = compare_table("IDA* (6-6-3 pattern databases)", &config, budget);
+    pdb_close(&pdb);
+    return ok;
+}
+
+// Batch heuristic scoring with every kernel this CPU supports, checked
+// against the scalar kernel and, on a sample, against solver_heuristic
+static int bench_heuristic(int argc, char *argv[]) {
+    size_t count = argc > 0 ? (size_t)atol(argv[0]) : 1000000;
+    PackedBoard *boards = malloc(count * sizeof(PackedBoard));
+    StateScore *expected = malloc(count * sizeof(StateScore));
+    StateScore *scores = malloc(count * sizeof(StateScore));
+    Rng rng;
+    int ok = 1;
+
+    if (!boards || !expected || !scores) {
+        fprintf(stderr, "Out of memory\n");
+        free(boards);
+        free(expected);
+        free(scores);
+        return 0;
+    }
+    rng_seed(&rng, 1);
+
+    printf("== heuristic: batch scoring, %zu boards per size, best kernel %s ==\n", count,
+           heuristic_isa_name(heuristic_best_isa()));
+    for (int size = 3; ok && size <= PACKED_MAX_SIZE; size++) {
+        boardgen_bulk(boards, count, size, &rng);
+        printf("  %dx%d", size, size);
+        for (int isa = 0; isa < HEURISTIC_ISA_COUNT; isa++) {
+            StateScore *out = isa == HEURISTIC_SCALAR ? expected : scores;
+            if (!heuristic_isa_supported((HeuristicIsa)isa)) {
+                printf("  %s unsupported", heuristic_isa_name((HeuristicIsa)isa));
+                continue;
+            }
+            double start = now_seconds();
+            heuristic_score_with((HeuristicIsa)isa, boards, count, out);
+            double elapsed = now_seconds() - start;
+            if (isa != HEURISTIC_SCALAR && memcmp(scores, expected, count * sizeof(StateScore)) != 0) {
+                fprintf(stderr, "\n%s scores differ from scalar on %dx%d\n",
+                        heuristic_isa_name((HeuristicIsa)isa), size, size);
+                ok = 0;
+            }
+            printf("  %s %.1f Mstates/s", heuristic_isa_name((HeuristicIsa)isa),
+                   elapsed > 0 ? (double)count / elapsed / 1e6 : 0.0);
+        }
+        printf("\n");
+
+        // solver_heuristic builds its tables on every call, so only a sample
+        for (size_t i = 0; ok && i < count; i += 997) {
+            if (expected[i].total != solver_heuristic(&boards[i])) {
+                fprintf(stderr, "Board %zu scores %d, solver_heuristic %d\n", i,
+                        expected[i].total, solver_heuristic(&boards[i]));
+                ok = 0;
+            }
+        }
+    }
+    printf("\n");
+
+    free(boards);
+    free(expected);
+    free(scores);
+    return ok;
+}
+
+// Solves with scratch memory from malloc (an arena per solve) and from one
+// arena kept across solves: time, and the kept arena's allocations, heap
+// calls and peak bytes; heap calls should stop after the first solve
+static int compare_arena(const char *title, SolverConfig *config, const PackedBoard *boards,
+                         int count) {
+    Arena arena;
+    double times[2] = {0.0, 0.0};
+    uint64_t first_calls = 0;
+
+    arena_init(&arena, 0);
+    printf("== arena: %s, %d boards ==\n", title, count);
+    for (int i = 0; i < count; i++) {
+        SolverResult fresh, kept;
+
+        config->arena = NULL;
+        double fresh_time = solve_timed(&boards[i], config, &fresh);
+        config->arena = &arena;
+        double kept_time = solve_timed(&boards[i], config, &kept);
+        if (fresh_time < 0 || kept_time < 0 || fresh.length != kept.length) {
+            fprintf(stderr, "Board %d: lengths differ with a kept arena\n", i);
+            arena_free(&arena);
+            return 0;
+        }
+        if (i == 0) {
+            first_calls = arena.stats.heap_calls;
+        }
+        times[0] += fresh_time;
+        times[1] += kept_time;
+    }
+    printf("  per-solve arena %.3f s, kept arena %.3f s\n", times[0], times[1]);
+    printf("  %.1f allocations per solve, heap calls %llu in the first solve and %llu after,"
+           " peak %zu KB, %zu KB held\n\n",
+           count ? (double)arena.stats.allocations / count : 0.0,
+           (unsigned long long)first_calls,
+           (unsigned long long)(arena.stats.heap_calls - first_calls),
+           arena.stats.peak >> 10, arena.stats.capacity >> 10);
+    arena_free(&arena);
+    return 1;
+}
+
+static int bench_arena(int argc, char *argv[]) {
+    int threads = argc > 0 ? atoi(argv[0]) : 4;
+    int count = argc > 1 ? atoi(argv[1]) : 8;
+    PackedBoard boards[INSTANCE_COUNT];
+    SolverConfig config = {0};
+    PdbSet pdb;
+    Rng rng;
+    int ok = 1;
+
+    for (int i = 0; i < INSTANCE_COUNT; i++) {
+        packed_parse(&boards[i], instances_4x4[i]);
+    }
+    config.threads = threads > 1 ? threads : 2;
+    if (pdb_open(&pdb, BENCH_PDB_PATH)) {
+        config.pdb = &pdb;
+        ok = compare_arena("parallel IDA* (6-6-3 pattern databases), 4x4 set", &config, boards,
+                           INSTANCE_COUNT);
+        pdb_close(&pdb);
+    } else {
+        printf("== arena: parallel IDA* skipped, %s missing (run make tables) ==\n\n",
+               BENCH_PDB_PATH);
+    }
+
+    // Weighted bidirectional search on uniform 5x5 boards
+    PackedBoard *random = malloc((size_t)(count > 0 ? count : 1) * sizeof(PackedBoard));
+    if (!random) {
+        fprintf(stderr, "Out of memory\n");
+        return 0;
+    }
+    rng_seed(&rng, 1);
+    for (int i = 0; i < count; i++) {
+        boardgen_random(&random[i], 5, &rng);
+    }
+    memset(&config, 0, sizeof(config));
+    config.engine = SOLVER_ENGINE_BIDIRECTIONAL;
+    config.weight = 200;
+    config.threads = threads;
+    ok = ok && compare_arena("weighted bidirectional, uniform random 5x5", &config, random, count);
+    free(random);
+    return ok;
+}
+
+// Disk-backed breadth-first search: the whole 3x3 space with tiny memory
+// budgets (many runs per layer), with the visited bitmap and with merging,
+// checked against the distance table; then 4x4 layers up to a depth, checked
+// against the published counts
+static const uint64_t layers_4x4[] = {
+    1, 2, 4, 10, 24, 54, 107, 212, 446, 946, 1948, 3938, 7808, 15544, 30821, 60842,
+    119000, 231844, 447342, 859744, 1637383, 3098270, 5802411, 10783780
+};
+#define KNOWN_4X4_LAYERS (int)(sizeof(layers_4x4) / sizeof(layers_4x4[0]))
+
+static int run_diskbfs(DiskBfsConfig *config, DiskBfsResult *result, double *elapsed) {
+    double start = now_seconds();
+    int ok = diskbfs_run(config, result);
+
+    *elapsed = now_seconds() - start;
+    if (!ok) {
+        fprintf(stderr, "Breadth-first search failed in %s\n", config->directory);
+        return 0;
+    }
+    printf("  %-8s %8.3f s  %.2f Mstates/s  %llu states, %d layers, %llu runs,"
+           " %.2f bytes per state written\n",
+           result->used_bitmap ? "bitmap" : "merging", *elapsed,
+           *elapsed > 0 ? (double)result->states / *elapsed / 1e6 : 0.0,
+           (unsigned long long)result->states, result->depth_count,
+           (unsigned long long)result->runs,
+           result->states ? (double)result->bytes_written / (double)result->states : 0.0);
+    return 1;
+}
+
+static int bench_diskbfs(int argc, char *argv[]) {
+    int depth = argc > 0 ? atoi(argv[0]) : 20;
+    size_t memory = argc > 1 ? (size_t)atol(argv[1]) << 20 : (size_t)64 << 20;
+    char directory[] = "/tmp/taquin-bfs-XXXXXX";
+    DiskBfsConfig config = {0};
+    DiskBfsResult result;
+    DistTable table;
+    double elapsed;
+    int ok = 1;
+
+    if (!mkdtemp(directory) || !dist_build(&table, 3)) {
+        fprintf(stderr, "Cannot create %s or build the distance table\n", directory);
+        return 0;
+    }
+    uint64_t expected[DISKBFS_MAX_DEPTH] = {0};
+    int diameter = dist_max(&table);
+    for (uint64_t i = 0; i < table.states; i++) {
+        expected[table.distances[i]]++;
+    }
+    dist_free(&table);
+
+    printf("== diskbfs: whole 3x3 space in %s, 64 KB and 32 KB budgets ==\n", directory);
+    config.directory = directory;
+    config.size = 3;
+    static const size_t budgets[] = {64 << 10, 32 << 10};
+    for (int b = 0; ok && b < 2; b++) {
+        config.memory_bytes = budgets[b];
+        ok = run_diskbfs(&config, &result, &elapsed);
+        if (ok && (!result.complete || result.depth_count != diameter + 1 ||
+                   memcmp(result.layer_states, expected, sizeof(expected)) != 0)) {
+            fprintf(stderr, "3x3 layers differ from the distance table\n");
+            ok = 0;
+        }
+    }
+
+    if (ok) {
+        printf("\n== diskbfs: 4x4 to depth %d, %zu MB budget ==\n", depth, memory >> 20);
+        config.size = 4;
+        config.memory_bytes = memory;
+        config.max_depth = depth;
+        ok = run_diskbfs(&config, &result, &elapsed);
+        for (int d = 0; ok && d < result.depth_count && d < KNOWN_4X4_LAYERS; d++) {
+            if (result.layer_states[d] != layers_4x4[d]) {
+                fprintf(stderr, "4x4 depth %d: %llu states, expected %llu\n", d,
+                        (unsigned long long)result.layer_states[d],
+                        (unsigned long long)layers_4x4[d]);
+                ok = 0;
+            }
+        }
+        if (ok) {
+            printf("  deepest layer %d: %llu states\n", result.depth_count - 1,
+                   (unsigned long long)result.layer_states[result.depth_count - 1]);
+        }
+    }
+    printf("\n");
+    rmdir(directory);
+    return ok;
+}
+
+#if TAQUIN_PROFILE
+#define PROFILE_BENCH_VALUES 100000
+#define PROFILE_BENCH_WAVES 3
+
+typedef struct {
+    int rounds;
+} ProfileWorker;
+
+// Every thread records 1..PROFILE_BENCH_VALUES, once per round
+static void *profile_worker(void *arg) {
+    const ProfileWorker *worker = arg;
+    for (int r = 0; r < worker->rounds; r++) {
+        for (uint64_t v = 1; v <= PROFILE_BENCH_VALUES; v++) {
+            profile_record(PROFILE_SOLVE, v);
+        }
+    }
+    profile_thread_exit();
+    return NULL;
+}
+
+static int bench_profile(int argc, char *argv[]) {
+    long timers = (argc > 0 ? atol(argv[0]) : 10) * 1000000L;
+    int threads = argc > 1 ? atoi(argv[1]) : 4;
+    pthread_t ids[PROFILE_MAX_THREADS];
+    ProfileWorker worker = {4};
+    ProfileHistogram histogram;
+    int ok = 1;
+
+    profile_init();
+    printf("== profile: %ld scoped timers ==\n", timers);
+    double start = now_seconds();
+    for (long i = 0; i < timers; i++) {
+        PROFILE_BEGIN(PROFILE_UPDATE);
+        PROFILE_END(PROFILE_UPDATE);
+    }
+    double elapsed = now_seconds() - start;
+    profile_snapshot(PROFILE_UPDATE, &histogram);
+    printf("  %.1f ns per timer, %.3f ns per tick, empty timer p50 %.1f ns\n\n",
+           elapsed * 1e9 / (double)timers, profile_ns_per_tick(),
+           (double)profile_percentile(&histogram, 0.50) * profile_ns_per_tick());
+    if (histogram.count != (uint64_t)timers) {
+        fprintf(stderr, "%llu timers recorded\n", (unsigned long long)histogram.count);
+        return 0;
+    }
+
+    // Percentiles of a known uniform spread, recorded from several threads;
+    // successive waves take over the slots the ones before released
+    threads = threads < 1 ? 1 : threads > PROFILE_MAX_THREADS - 1 ? PROFILE_MAX_THREADS - 1 : threads;
+    printf("== profile: 1..%d recorded %d times by %d waves of %d threads ==\n",
+           PROFILE_BENCH_VALUES, worker.rounds, PROFILE_BENCH_WAVES, threads);
+    start = now_seconds();
+    for (int wave = 0; wave < PROFILE_BENCH_WAVES; wave++) {
+        for (int t = 0; t < threads; t++) {
+            pthread_create(&ids[t], NULL, profile_worker, &worker);
+        }
+        for (int t = 0; t < threads; t++) {
+            pthread_join(ids[t], NULL);
+        }
+    }
+    elapsed = now_seconds() - start;
+    profile_snapshot(PROFILE_SOLVE, &histogram);
+    uint64_t samples = (uint64_t)PROFILE_BENCH_WAVES * (uint64_t)threads * (uint64_t)worker.rounds *
+                       PROFILE_BENCH_VALUES;
+    printf("  %.1f M records/s\n", (double)samples / elapsed / 1e6);
+    if (histogram.count != samples || histogram.max != PROFILE_BENCH_VALUES || profile_dropped()) {
+        fprintf(stderr, "%llu samples (max %llu, %llu dropped), expected %llu\n",
+                (unsigned long long)histogram.count, (unsigned long long)histogram.max,
+                (unsigned long long)profile_dropped(), (unsigned long long)samples);
+        ok = 0;
+    }
+    static const double fractions[] = {0.10, 0.50, 0.90, 0.99};
+    for (int f = 0; f < 4; f++) {
+        double exact = fractions[f] * PROFILE_BENCH_VALUES;
+        double got = (double)profile_percentile(&histogram, fractions[f]);
+        double error = (got - exact) / exact;
+        printf("  p%-2d %8.0f (exact %6.0f, %+.2f%%)\n", (int)(fractions[f] * 100), got, exact,
+               error * 100.0);
+        if (error > 1.0 / 16 || error < -1.0 / 16) {
+            fprintf(stderr, "Percentile outside the histogram's 1/16 resolution\n");
+            ok = 0;
+        }
+    }
+    printf("\n");
+    return ok;
+}
+#else
+static int bench_profile(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    printf("== profile: skipped, built with PROFILE=0 ==\n\n");
+    return 1;
+}
+#endif // TAQUIN_PROFILE
+
+typedef struct {
+    const char *name;
+    int (*run)(int argc, char *argv[]);
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"solver", bench_solver},
+    {"pdb", bench_pdb},
+    {"scaling", bench_scaling},
+    {"boardgen", bench_boardgen},
+    {"moves", bench_moves},
+    {"rank", bench_rank},
+    {"assets", bench_assets},
+    {"bidir", bench_bidir},
+    {"reduce", bench_reduce},
+    {"ttable", bench_ttable},
+    {"heuristic", bench_heuristic},
+    {"arena", bench_arena},
+    {"diskbfs", bench_diskbfs},
+    {"profile", bench_profile}
+};
+#define BENCHMARK_COUNT (int)(sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+int main(int argc, char *argv[]) {
+    int ran = 0;
+
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        if (argc > 1 && strcmp(argv[1], benchmarks[i].name) != 0) {
+            continue;
+        }
+        if (!benchmarks[i].run(argc > 2 ? argc - 2 : 0, argv + 2)) {
+            return EXIT_FAILURE;
+        }
+        ran++;
+    }
+
+    if (!ran) {
+        fprintf(stderr, "Unknown benchmark: %s\nAvailable:", argv[1]);
+        for (int i = 0; i < BENCHMARK_COUNT; i++) {
+            fprintf(stderr, " %s", benchmarks[i].name);
+        }
+        fprintf(stderr, "\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
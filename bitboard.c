@@ -0,0 +1,74 @@
+#include <stdlib.h>
+#include "bitboard.h"
+
+// Solved-state words per board size (tile i + 1 in cell i, empty last)
+static const uint64_t goal_words[PACKED_MAX_SIZE + 1][2] = {
+    {0, 0}, {0, 0}, {0, 0},
+    {0x0000000087654321ULL, 0},
+    {0x0FEDCBA987654321ULL, 0},
+    {0xD62D4941CC520C41ULL, 0x00C5ED5A4E5183DCULL}
+};
+
+static int field_bits(int size) {
+    return size * size <= 16 ? 4 : 5;
+}
+
+int packed_init(PackedBoard *pb, int size) {
+    if (size < 3 || size > PACKED_MAX_SIZE) {
+        return 0;
+    }
+
+    pb->size = (uint8_t)size;
+    pb->bits = (uint8_t)field_bits(size);
+    pb->empty = (uint8_t)(size * size - 1);
+    pb->words[0] = goal_words[size][0];
+    pb->words[1] = goal_words[size][1];
+    return 1;
+}
+
+int packed_is_solved(const PackedBoard *pb) {
+    return pb->words[0] == goal_words[pb->size][0] &&
+           pb->words[1] == goal_words[pb->size][1];
+}
+
+int packed_parse(PackedBoard *pb, const char *text) {
+    int tiles[PACKED_MAX_CELLS];
+    int count = 0;
+    const char *p = text;
+
+    while (count < PACKED_MAX_CELLS) {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < 0 || value >= PACKED_MAX_CELLS) {
+            break;
+        }
+        tiles[count++] = (int)value;
+        p = end;
+    }
+
+    int size = count == 9 ? 3 : count == 16 ? 4 : count == 25 ? 5 : 0;
+    if (size == 0) {
+        return 0;
+    }
+
+    // Every tile must appear exactly once
+    unsigned long seen = 0;
+    for (int cell = 0; cell < count; cell++) {
+        if (tiles[cell] >= count || (seen & (1UL << tiles[cell]))) {
+            return 0;
+        }
+        seen |= 1UL << tiles[cell];
+    }
+
+    pb->size = (uint8_t)size;
+    pb->bits = (uint8_t)field_bits(size);
+    pb->words[0] = 0;
+    pb->words[1] = 0;
+    for (int cell = 0; cell < count; cell++) {
+        if (tiles[cell] == 0) {
+            pb->empty = (uint8_t)cell;
+        }
+        packed_xor(pb, cell, (uint64_t)tiles[cell]);
+    }
+    return (int)(p - text);
+}
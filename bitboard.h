@@ -0,0 +1,117 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+// Packed board limits
+#define PACKED_MAX_SIZE 5
+#define PACKED_MAX_CELLS (PACKED_MAX_SIZE * PACKED_MAX_SIZE)
+
+// Directions the empty tile can travel (same order as shuffle_board)
+typedef enum {
+    MOVE_LEFT,
+    MOVE_RIGHT,
+    MOVE_UP,
+    MOVE_DOWN,
+    MOVE_COUNT
+} MoveDirection;
+
+// Packed board state
+// Cells are numbered row-major (cell = y * size + x) and each cell holds its
+// tile in a fixed-width field: 4 bits for 3x3/4x4 (one word), 5 bits for 5x5
+// (125 bits across both words, cell 12 straddles the word boundary).
+typedef struct {
+    uint64_t words[2];
+    uint8_t size;
+    uint8_t bits;   // Field width per cell
+    uint8_t empty;  // Cell index of the empty tile
+} PackedBoard;
+
+// Construction (see board.h for conversion to and from runtime-sized boards)
+int packed_init(PackedBoard *pb, int size);
+int packed_is_solved(const PackedBoard *pb);
+
+// Text form: tiles in row-major order separated by spaces, 0 for the empty
+// cell (9, 16 or 25 numbers); returns the number of characters consumed
+int packed_parse(PackedBoard *pb, const char *text);
+
+// Tile stored at a cell
+static inline int packed_get(const PackedBoard *pb, int cell) {
+    unsigned shift = (unsigned)cell * pb->bits;
+    uint64_t mask = ((uint64_t)1 << pb->bits) - 1;
+    uint64_t value;
+
+    if (shift >= 64) {
+        value = pb->words[1] >> (shift - 64);
+    } else {
+        value = pb->words[0] >> shift;
+        if (shift + pb->bits > 64) {
+            value |= pb->words[1] << (64 - shift);
+        }
+    }
+    return (int)(value & mask);
+}
+
+// XOR a value into a cell's field (swapping a tile with the empty cell is
+// two XORs, so no field ever needs clearing)
+static inline void packed_xor(PackedBoard *pb, int cell, uint64_t value) {
+    unsigned shift = (unsigned)cell * pb->bits;
+
+    if (shift >= 64) {
+        pb->words[1] ^= value << (shift - 64);
+    } else {
+        pb->words[0] ^= value << shift;
+        if (shift + pb->bits > 64) {
+            pb->words[1] ^= value >> (64 - shift);
+        }
+    }
+}
+
+// Cell the empty tile would move to, or -1 if it would leave the board
+static inline int packed_neighbor(const PackedBoard *pb, int dir) {
+    int size = pb->size;
+    int x = pb->empty % size;
+    int y = pb->empty / size;
+
+    switch (dir) {
+        case MOVE_LEFT:  return x > 0 ? pb->empty - 1 : -1;
+        case MOVE_RIGHT: return x < size - 1 ? pb->empty + 1 : -1;
+        case MOVE_UP:    return y > 0 ? pb->empty - size : -1;
+        case MOVE_DOWN:  return y < size - 1 ? pb->empty + size : -1;
+    }
+    return -1;
+}
+
+// Slide the tile at an adjacent cell into the empty cell; returns the tile
+static inline int packed_move_cell(PackedBoard *pb, int cell) {
+    int tile = packed_get(pb, cell);
+
+    packed_xor(pb, cell, (uint64_t)tile);
+    packed_xor(pb, pb->empty, (uint64_t)tile);
+    pb->empty = (uint8_t)cell;
+    return tile;
+}
+
+// Move the empty tile one step; returns the tile that slid, 0 if illegal
+static inline int packed_move(PackedBoard *pb, int dir) {
+    int cell = packed_neighbor(pb, dir);
+    return cell < 0 ? 0 : packed_move_cell(pb, cell);
+}
+
+static inline int packed_equal(const PackedBoard *a, const PackedBoard *b) {
+    return a->words[0] == b->words[0] && a->words[1] == b->words[1] &&
+           a->size == b->size;
+}
+
+// 64-bit state hash (splitmix64 finalizer over both words)
+static inline uint64_t packed_hash(const PackedBoard *pb) {
+    uint64_t h = pb->words[0] ^ (pb->words[1] * 0x9E3779B97F4A7C15ULL) ^ pb->size;
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+#endif // BITBOARD_H
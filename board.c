@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+
+int board_init(Board *board, int size) {
+    if (size < BOARD_MIN_SIZE || size > BOARD_MAX_SIZE) {
+        return 0;
+    }
+
+    int cells = size * size;
+    if (!board->tiles || board->cells != cells) {
+        uint16_t *tiles = realloc(board->tiles, (size_t)cells * sizeof(uint16_t));
+        if (!tiles) {
+            return 0;
+        }
+        board->tiles = tiles;
+    }
+    board->size = size;
+    board->cells = cells;
+    board->empty = cells - 1;
+    board->misplaced = 0;
+    board->manhattan = 0;
+    for (int cell = 0; cell < cells; cell++) {
+        board->tiles[cell] = (uint16_t)board_goal(board, cell);
+    }
+    return 1;
+}
+
+void board_free(Board *board) {
+    free(board->tiles);
+    memset(board, 0, sizeof(*board));
+}
+
+int board_copy(Board *dest, const Board *src) {
+    if (!board_init(dest, src->size)) {
+        return 0;
+    }
+    memcpy(dest->tiles, src->tiles, (size_t)src->cells * sizeof(uint16_t));
+    dest->empty = src->empty;
+    dest->misplaced = src->misplaced;
+    dest->manhattan = src->manhattan;
+    return 1;
+}
+
+// Full recount of the distance to the goal after tiles were written directly
+void board_recount(Board *board) {
+    board->misplaced = 0;
+    board->manhattan = 0;
+    for (int cell = 0; cell < board->cells; cell++) {
+        int tile = board->tiles[cell];
+        if (tile != 0 && tile - 1 != cell) {
+            board->misplaced++;
+            board->manhattan += board_distance(board, cell, tile - 1);
+        }
+    }
+}
+
+// Solvable exactly when the permutation parity (from its cycle count)
+// matches the parity of the empty cell's distance from home
+int board_is_solvable(const Board *board) {
+    uint8_t seen[BOARD_MAX_CELLS] = {0};
+    int cells = board->cells;
+    int cycles = 0;
+
+    for (int start = 0; start < cells; start++) {
+        if (seen[start]) {
+            continue;
+        }
+        cycles++;
+        for (int cell = start; !seen[cell];) {
+            int tile = board->tiles[cell];
+            seen[cell] = 1;
+            cell = tile == 0 ? cells - 1 : tile - 1;  // Home of the tile here
+        }
+    }
+
+    int size = board->size;
+    int distance = (size - 1 - board->empty % size) + (size - 1 - board->empty / size);
+    return ((cells - cycles) & 1) == (distance & 1);
+}
+
+int board_to_packed(const Board *board, PackedBoard *pb) {
+    if (!packed_init(pb, board->size)) {
+        return 0;
+    }
+    pb->words[0] = 0;
+    pb->words[1] = 0;
+    pb->empty = (uint8_t)board->empty;
+    for (int cell = 0; cell < board->cells; cell++) {
+        packed_xor(pb, cell, board->tiles[cell]);
+    }
+    return 1;
+}
+
+int board_from_packed(Board *board, const PackedBoard *pb) {
+    if (!board_init(board, pb->size)) {
+        return 0;
+    }
+    for (int cell = 0; cell < board->cells; cell++) {
+        board->tiles[cell] = (uint16_t)packed_get(pb, cell);
+    }
+    board->empty = pb->empty;
+    board_recount(board);
+    return 1;
+}
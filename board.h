@@ -0,0 +1,103 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+#include "bitboard.h"
+
+// Runtime-sized board limits
+#define BOARD_MIN_SIZE 3
+#define BOARD_MAX_SIZE 32
+#define BOARD_MAX_CELLS (BOARD_MAX_SIZE * BOARD_MAX_SIZE)
+
+// Board of any supported size, heap-allocated: one 16-bit tile per cell in
+// row-major order (cell = y * size + x), 0 for the empty cell. Boards up to
+// PACKED_MAX_SIZE convert to PackedBoard for the solver.
+// The distance to the goal is kept up to date by every slide, so checking
+// for a win costs O(1); code that writes tiles directly calls
+// board_recount() afterwards.
+typedef struct {
+    int size;
+    int cells;
+    int empty;        // Cell index of the empty tile
+    int misplaced;    // Tiles off their goal cell, the empty cell excluded
+    int manhattan;    // Sum of their Manhattan distances to it
+    uint16_t *tiles;
+} Board;
+
+// Make a solved board; the struct must start zeroed or initialised, and an
+// initialised board is resized in place
+int board_init(Board *board, int size);
+void board_free(Board *board);
+int board_copy(Board *dest, const Board *src);
+
+void board_recount(Board *board);
+int board_is_solvable(const Board *board);
+
+// Conversion for the solver; board_to_packed fails above PACKED_MAX_SIZE
+int board_to_packed(const Board *board, PackedBoard *pb);
+int board_from_packed(Board *board, const PackedBoard *pb);
+
+// Tile a cell holds when solved
+static inline int board_goal(const Board *board, int cell) {
+    return cell == board->cells - 1 ? 0 : cell + 1;
+}
+
+static inline int board_at(const Board *board, int x, int y) {
+    return board->tiles[y * board->size + x];
+}
+
+static inline int board_is_solved(const Board *board) {
+    return board->misplaced == 0;
+}
+
+// Manhattan distance between two cells
+static inline int board_distance(const Board *board, int a, int b) {
+    int dx = a % board->size - b % board->size;
+    int dy = a / board->size - b / board->size;
+    return (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+}
+
+// Cell the empty tile would move to, or -1 if it would leave the board
+static inline int board_neighbor(const Board *board, int dir) {
+    int size = board->size;
+    int x = board->empty % size;
+    int y = board->empty / size;
+
+    switch (dir) {
+        case MOVE_LEFT:  return x > 0 ? board->empty - 1 : -1;
+        case MOVE_RIGHT: return x < size - 1 ? board->empty + 1 : -1;
+        case MOVE_UP:    return y > 0 ? board->empty - size : -1;
+        case MOVE_DOWN:  return y < size - 1 ? board->empty + size : -1;
+        default:         return -1;
+    }
+}
+
+// Direction the empty tile travels when the tile at an adjacent cell slides
+static inline int board_direction(const Board *board, int cell) {
+    int delta = cell - board->empty;
+    return delta == -1 ? MOVE_LEFT : delta == 1 ? MOVE_RIGHT : delta < 0 ? MOVE_UP : MOVE_DOWN;
+}
+
+// Whether the tile at a cell can slide into the empty cell
+static inline int board_adjacent(const Board *board, int cell) {
+    int size = board->size;
+    int dx = cell % size - board->empty % size;
+    int dy = cell / size - board->empty / size;
+    return (dx == 0 && (dy == 1 || dy == -1)) || (dy == 0 && (dx == 1 || dx == -1));
+}
+
+// Slide the tile at an adjacent cell into the empty cell; returns the tile
+static inline int board_slide(Board *board, int cell) {
+    int tile = board->tiles[cell];
+    int goal = tile - 1;
+
+    // Only this tile moves, so only its own distance changes
+    board->misplaced += (board->empty != goal) - (cell != goal);
+    board->manhattan += board_distance(board, board->empty, goal) - board_distance(board, cell, goal);
+    board->tiles[board->empty] = (uint16_t)tile;
+    board->tiles[cell] = 0;
+    board->empty = cell;
+    return tile;
+}
+
+#endif // BOARD_H
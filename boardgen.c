@@ -0,0 +1,141 @@
+#include "boardgen.h"
+
+// PRNG
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void rng_seed(Rng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&seed);
+    }
+}
+
+uint64_t rng_next(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Multiply-shift with rejection of the biased low range (Lemire)
+uint32_t rng_below(Rng *rng, uint32_t bound) {
+    uint64_t product = (rng_next(rng) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            product = (rng_next(rng) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+// Generation
+// Fisher-Yates from the solved state, tracking parity: each real swap flips
+// it. Solvable exactly when the permutation parity matches the parity of
+// the empty cell's distance from home; otherwise swap two tiles, which
+// pairs every unsolvable board with exactly one solvable one. Returns the
+// empty cell.
+static int random_tiles(uint16_t *tiles, int size, Rng *rng) {
+    int cells = size * size;
+    int odd = 0;
+    int blank = cells - 1;
+
+    for (int cell = 0; cell < cells; cell++) {
+        tiles[cell] = (uint16_t)((cell + 1) % cells);
+    }
+    for (int i = cells - 1; i > 0; i--) {
+        int j = (int)rng_below(rng, (uint32_t)(i + 1));
+        if (j != i) {
+            uint16_t tile = tiles[i];
+            tiles[i] = tiles[j];
+            tiles[j] = tile;
+            odd ^= 1;
+        }
+    }
+    for (int cell = 0; cell < cells; cell++) {
+        if (tiles[cell] == 0) {
+            blank = cell;
+        }
+    }
+
+    int distance = (size - 1 - blank % size) + (size - 1 - blank / size);
+    if (odd != (distance & 1)) {
+        int a = blank == 0 ? 1 : 0;
+        int b = blank <= 1 ? 2 : 1;
+        uint16_t tile = tiles[a];
+        tiles[a] = tiles[b];
+        tiles[b] = tile;
+    }
+    return blank;
+}
+
+void boardgen_random(PackedBoard *pb, int size, Rng *rng) {
+    uint16_t tiles[PACKED_MAX_CELLS];
+    int blank = random_tiles(tiles, size, rng);
+
+    packed_init(pb, size);
+    pb->words[0] = 0;
+    pb->words[1] = 0;
+    pb->empty = (uint8_t)blank;
+    for (int cell = 0; cell < size * size; cell++) {
+        packed_xor(pb, cell, tiles[cell]);
+    }
+}
+
+int boardgen_board(Board *board, int size, Rng *rng) {
+    if (!board_init(board, size)) {
+        return 0;
+    }
+    board->empty = random_tiles(board->tiles, size, rng);
+    board_recount(board);
+    return 1;
+}
+
+int boardgen_targeted(PackedBoard *pb, int size, Rng *rng, const BoardTarget *target,
+                      const SolverConfig *config) {
+    int attempts = target->max_attempts > 0 ? target->max_attempts : 100000;
+
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        boardgen_random(pb, size, rng);
+
+        if (target->min_heuristic || target->max_heuristic) {
+            int h = solver_heuristic(pb);
+            if (h < target->min_heuristic ||
+                (target->max_heuristic && h > target->max_heuristic)) {
+                continue;
+            }
+        }
+        if (target->min_length) {
+            SolverResult result;
+            if (!solver_solve_with(pb, config, &result) || result.length < target->min_length) {
+                continue;
+            }
+        }
+        return 1;
+    }
+    return 0;
+}
+
+void boardgen_bulk(PackedBoard *boards, size_t count, int size, Rng *rng) {
+    for (size_t i = 0; i < count; i++) {
+        boardgen_random(&boards[i], size, rng);
+    }
+}
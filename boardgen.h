@@ -0,0 +1,41 @@
+#ifndef BOARDGEN_H
+#define BOARDGEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bitboard.h"
+#include "board.h"
+#include "solver.h"
+
+// Seedable PRNG (xoshiro256**, seeded through splitmix64)
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+void rng_seed(Rng *rng, uint64_t seed);
+uint64_t rng_next(Rng *rng);
+uint32_t rng_below(Rng *rng, uint32_t bound);  // Unbiased, bound > 0
+
+// Difficulty request; zero fields are ignored
+typedef struct {
+    int min_length;     // Optimal solution at least this long (runs the solver)
+    int min_heuristic;  // Manhattan + linear-conflict estimate band
+    int max_heuristic;
+    int max_attempts;   // Candidates to try before giving up (0: 100000)
+} BoardTarget;
+
+// Uniformly random solvable board: a shuffled permutation whose parity is
+// repaired by swapping two tiles, so every solvable state is equally likely
+void boardgen_random(PackedBoard *pb, int size, Rng *rng);
+
+// The same distribution for runtime-sized boards of any supported size
+int boardgen_board(Board *board, int size, Rng *rng);
+
+// Random boards until one meets the target; returns 0 if attempts run out
+int boardgen_targeted(PackedBoard *pb, int size, Rng *rng, const BoardTarget *target,
+                      const SolverConfig *config);
+
+// Fill an array with uniformly random solvable boards
+void boardgen_bulk(PackedBoard *boards, size_t count, int size, Rng *rng);
+
+#endif // BOARDGEN_H
@@ -35,10 +35,120 @@ if errorlevel 1 (
     exit /b 1
 )
 
+gcc -Wall -Wextra -std=c99 -O2 -c atlas.c -o obj/atlas.o -IC:/development/i686-w64-mingw32/include/SDL2 -IC:/development/SDL2/x86_64-w64-mingw32/include/SDL2
+if errorlevel 1 (
+    echo Error compiling atlas.c
+    pause
+    exit /b 1
+)
+
+gcc -Wall -Wextra -std=c99 -O2 -c bitboard.c -o obj/bitboard.o
+if errorlevel 1 (
+    echo Error compiling bitboard.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c board.c -o obj/board.o
+if errorlevel 1 (
+    echo Error compiling board.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -pthread -c solver.c -o obj/solver.o
+if errorlevel 1 (
+    echo Error compiling solver.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c pdb.c -o obj/pdb.o
+if errorlevel 1 (
+    echo Error compiling pdb.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c boardgen.c -o obj/boardgen.o
+if errorlevel 1 (
+    echo Error compiling boardgen.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c rank.c -o obj/rank.o
+if errorlevel 1 (
+    echo Error compiling rank.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c disttable.c -o obj/disttable.o
+if errorlevel 1 (
+    echo Error compiling disttable.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c movelog.c -o obj/movelog.o
+if errorlevel 1 (
+    echo Error compiling movelog.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c scores.c -o obj/scores.o
+if errorlevel 1 (
+    echo Error compiling scores.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c reduce.c -o obj/reduce.o
+if errorlevel 1 (
+    echo Error compiling reduce.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c transtable.c -o obj/transtable.o
+if errorlevel 1 (
+    echo Error compiling transtable.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c heuristic.c -o obj/heuristic.o
+if errorlevel 1 (
+    echo Error compiling heuristic.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c arena.c -o obj/arena.o
+if errorlevel 1 (
+    echo Error compiling arena.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c diskbfs.c -o obj/diskbfs.o
+if errorlevel 1 (
+    echo Error compiling diskbfs.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c profile.c -o obj/profile.o
+if errorlevel 1 (
+    echo Error compiling profile.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c mapfile.c -o obj/mapfile.o
+if errorlevel 1 (
+    echo Error compiling mapfile.c
+    pause
+    exit /b 1
+)
+gcc -Wall -Wextra -std=c99 -O2 -c assetpack.c -o obj/assetpack.o
+if errorlevel 1 (
+    echo Error compiling assetpack.c
+    pause
+    exit /b 1
+)
+
 echo Linking executable...
 
 REM Link the executable
-gcc obj/main.o obj/game.o obj/render.o -o bin/taquin.exe -LC:/development/i686-w64-mingw32/lib -LC:/development/SDL2/x86_64-w64-mingw32/lib -lmingw32 -lSDL2main -lSDL2
+gcc obj/main.o obj/game.o obj/render.o obj/atlas.o obj/bitboard.o obj/board.o obj/solver.o obj/pdb.o obj/boardgen.o obj/rank.o obj/disttable.o obj/mapfile.o obj/assetpack.o obj/movelog.o obj/scores.o obj/reduce.o obj/transtable.o obj/heuristic.o obj/arena.o obj/diskbfs.o obj/profile.o -o bin/taquin.exe -LC:/development/i686-w64-mingw32/lib -LC:/development/SDL2/x86_64-w64-mingw32/lib -lmingw32 -lSDL2main -lSDL2 -pthread
 if errorlevel 1 (
     echo Error linking executable
     pause
@@ -8,14 +8,31 @@
     #include <SDL2/SDL.h>
 #endif
 
+#include "assetpack.h"
+#include "board.h"
+#include "boardgen.h"
+#include "movelog.h"
+#include "profile.h"
+#include "reduce.h"
+#include "scores.h"
+
 // Game constants
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
-#define MAX_BOARD_SIZE 5
-#define MIN_BOARD_SIZE 3
-#define MAX_TEXTURES 25
-#define ANIMATION_SPEED 8
-#define SHUFFLE_MOVES 1000
+#define MAX_BOARD_SIZE BOARD_MAX_SIZE
+#define MIN_BOARD_SIZE BOARD_MIN_SIZE
+#define ANIMATION_MS 150       // Duration of one tile slide
+#define ANIMATION_QUEUE 64     // Slides that can wait behind the moving one
+#define ANIMATION_EASING EASE_OUT_CUBIC
+#define SIMULATION_HZ 60       // Fixed simulation steps per second
+#define TARGET_FPS 60          // Frame cap when vsync is unavailable
+#define MAX_CATCHUP_STEPS 6    // Steps replayed at most after a stall
+#define IDLE_WAIT_MS 500       // Longest event wait while nothing moves
+#define WINDOW_TITLE "Taquin - Sliding Puzzle"
+#define SOLVE_PROGRESS_INTERVAL 250  // Milliseconds between progress updates
+#define SOLVE_WEIGHT_5X5 150         // 5x5 hints: bidirectional search weight (percent)
+#define MOVELOG_PATH "data/games.log"    // Every game played, appended
+#define SCORES_FILE "scores.bin"         // In the user's preferences directory
 
 // Colors (RGBA)
 #define COLOR_BACKGROUND {30, 30, 30, 255}
@@ -25,6 +42,13 @@
 #define COLOR_TEXT {255, 255, 255, 255}
 #define COLOR_BUTTON {100, 149, 237, 255}
 #define COLOR_BUTTON_HOVER {135, 206, 250, 255}
+#define COLOR_HINT {255, 200, 0, 255}
+#define COLOR_PROGRESS {255, 200, 0, 255}
+#define COLOR_PROFILE_PANEL {0, 0, 0, 180}
+#define COLOR_PROFILE_BARS {140, 140, 140, 255}
+#define COLOR_PROFILE_P50 {255, 255, 255, 255}
+#define COLOR_PROFILE_P99 {255, 140, 0, 255}
+#define COLOR_PROFILE_INPUT {100, 170, 255, 255}
 
 // Game states
 typedef enum {
@@ -35,10 +59,44 @@ typedef enum {
     GAME_STATE_SETTINGS
 } GameState;
 
+// Easing curves for tile slides
+typedef enum {
+    EASE_LINEAR,
+    EASE_OUT_CUBIC,
+    EASE_IN_OUT_CUBIC
+} Easing;
+
+// One tile sliding into the empty cell next to it
+typedef struct {
+    int tile;
+    int from_x, from_y;
+    int to_x, to_y;
+} Slide;
+
+// What a background solve is for
+typedef enum {
+    SOLVE_HINT,
+    SOLVE_AUTO
+} SolveMode;
+
+// Every tile and interface image packed into one texture (atlas.c)
+#define ASSET_PACK_PATH "data/assets.pack"
+
+typedef struct {
+    SDL_Texture *texture;
+    int width, height;
+    SDL_Rect numbers[ASSET_NUMBER_COUNT];  // Source rect of tile i + 1; w == 0 if missing
+    SDL_Rect ui[ASSET_UI_COUNT];           // images/inteface/<i + 1>.bmp
+    SDL_Rect white;                        // Solid white block for untextured quads
+    SDL_Rect digits[10];                   // Glyphs for procedural tile labels
+    int pending;                           // Images still being decoded
+} Atlas;
+
 // Game statistics
 typedef struct {
     int moves;
     int time_seconds;
+    Uint64 play_ticks;  // Performance-counter ticks spent on this board
     int best_moves[MAX_BOARD_SIZE + 1];  // Index by board size
     int best_time[MAX_BOARD_SIZE + 1];   // Index by board size
 } GameStats;
@@ -46,19 +104,36 @@ typedef struct {
 // Game data structure
 typedef struct {
     int board_size;
-    int board[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
-    SDL_Texture* number_textures[MAX_TEXTURES];
-    SDL_Texture* ui_textures[6];  // Menu textures
+    Board board;            // Heap-allocated, row-major
+    Atlas atlas;
     SDL_Renderer* renderer;
     SDL_Window* window;
     GameState state;
     GameStats stats;
-    int empty_x, empty_y;  // Position of empty tile
-    SDL_bool is_animating;
-    int animation_progress;
-    int animation_start_x, animation_start_y;
-    int animation_end_x, animation_end_y;
-    int animation_tile;
+    SDL_bool is_animating;  // Slides queued or moving
+    Board display;          // Board as shown, behind board while sliding
+    Slide slides[ANIMATION_QUEUE];  // Ring buffer; the first one is moving
+    int slide_first, slide_count;
+    Uint64 slide_start;     // Performance counter when the moving slide began
+    Uint64 slide_ticks;     // Its duration
+    SDL_bool win_pending;   // Solved; the win screen waits for the last slide
+    SDL_bool solving;     // Background search running
+    SDL_bool hint_shown;
+    int hint_x, hint_y;   // Tile to slide next
+    SDL_bool autoplay;    // Playing back a solution
+    size_t autoplay_index;
+    MovePlan autoplay_plan;
+    MoveLogWriter log;    // Move log, file NULL when games are not recorded
+    MoveLogGame record;   // Game in progress
+    SDL_bool recording;
+    MoveLogGame replay;   // Game being played back from the log
+    SDL_bool replaying;
+    size_t replay_index;
+    uint64_t seed;        // Master seed (0 picks one from the clock at startup)
+    uint64_t board_seed;  // Seed the current shuffle was drawn from
+    Rng rng;
+    ScoreFile scores;     // Leaderboards and settings, saved in the background
+    SDL_bool show_profile;  // F3 frame-time overlay (profiling builds)
 } GameData;
 
 // Global game instance
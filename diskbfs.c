@@ -0,0 +1,379 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitboard.h"
+#include "diskbfs.h"
+#include "rank.h"
+
+// stdio buffer per open file, so reads and writes reach the disk in large
+// sequential blocks
+#define STREAM_BUFFER_BYTES ((size_t)256 << 10)
+
+// Smallest sort buffer, in states
+#define MIN_BUFFER_STATES 4096
+
+// Sorted ranks in a file, each stored as a varint of its difference from
+// the one before
+typedef struct {
+    FILE *file;
+    char *buffer;
+    uint64_t last;
+    uint64_t count;
+    uint64_t bytes;
+} Stream;
+
+typedef struct {
+    const DiskBfsConfig *config;
+    DiskBfsResult *result;
+    uint8_t *visited;    // Bit per rank, NULL when the merge drops duplicates
+    uint64_t *buffer;
+    size_t capacity;
+    size_t count;
+    int first_run;       // Runs waiting to be merged are [first_run, next_run)
+    int next_run;
+} Bfs;
+
+static int stream_open(Stream *stream, const char *path, const char *mode) {
+    memset(stream, 0, sizeof(*stream));
+    stream->file = fopen(path, mode);
+    stream->buffer = malloc(STREAM_BUFFER_BYTES);
+    if (!stream->file || !stream->buffer) {
+        if (stream->file) {
+            fclose(stream->file);
+        }
+        free(stream->buffer);
+        return 0;
+    }
+    setvbuf(stream->file, stream->buffer, _IOFBF, STREAM_BUFFER_BYTES);
+    return 1;
+}
+
+// Returns 0 if anything went wrong while the file was open
+static int stream_close(Stream *stream) {
+    int ok = !ferror(stream->file);
+
+    ok = fclose(stream->file) == 0 && ok;
+    free(stream->buffer);
+    stream->file = NULL;
+    stream->buffer = NULL;
+    return ok;
+}
+
+static void stream_put(Stream *stream, uint64_t rank) {
+    uint64_t delta = rank - stream->last;
+
+    while (delta >= 0x80) {
+        putc_unlocked((int)(delta & 0x7F) | 0x80, stream->file);
+        delta >>= 7;
+        stream->bytes++;
+    }
+    putc_unlocked((int)delta, stream->file);
+    stream->bytes++;
+    stream->last = rank;
+    stream->count++;
+}
+
+// 0 at the end of the file
+static int stream_get(Stream *stream, uint64_t *rank) {
+    uint64_t delta = 0;
+    int shift = 0;
+    int c;
+
+    while ((c = getc_unlocked(stream->file)) != EOF) {
+        stream->bytes++;
+        delta |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            stream->last += delta;
+            stream->count++;
+            *rank = stream->last;
+            return 1;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+static void file_path(char *path, size_t length, const Bfs *bfs, const char *kind, int index) {
+    snprintf(path, length, "%s/%s-%06d.bin", bfs->config->directory, kind, index);
+}
+
+static int compare_ranks(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sort the buffer and write it out as the next run, duplicates dropped
+static int spill_run(Bfs *bfs) {
+    char path[1024];
+    Stream run;
+
+    if (bfs->count == 0) {
+        return 1;
+    }
+    qsort(bfs->buffer, bfs->count, sizeof(uint64_t), compare_ranks);
+    file_path(path, sizeof(path), bfs, "run", bfs->next_run);
+    if (!stream_open(&run, path, "wb")) {
+        return 0;
+    }
+    for (size_t i = 0; i < bfs->count; i++) {
+        if (i == 0 || bfs->buffer[i] != bfs->buffer[i - 1]) {
+            stream_put(&run, bfs->buffer[i]);
+        }
+    }
+    bfs->result->bytes_written += run.bytes;
+    bfs->result->runs++;
+    bfs->next_run++;
+    bfs->count = 0;
+    return stream_close(&run);
+}
+
+// Min-heap of run indexes by their current rank
+static void sift_down(int *heap, int count, const uint64_t *heads, int i) {
+    for (;;) {
+        int smallest = i;
+        int left = 2 * i + 1, right = left + 1;
+        if (left < count && heads[heap[left]] < heads[heap[smallest]]) {
+            smallest = left;
+        }
+        if (right < count && heads[heap[right]] < heads[heap[smallest]]) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        int swap = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = swap;
+        i = smallest;
+    }
+}
+
+// Merge runs [first, first + ways) into out, each rank once and none that
+// the optional exclude stream holds; the runs are deleted afterwards
+static int merge_runs(Bfs *bfs, int first, int ways, Stream *out, Stream *exclude) {
+    Stream runs[DISKBFS_MERGE_WAYS];
+    uint64_t heads[DISKBFS_MERGE_WAYS];
+    int heap[DISKBFS_MERGE_WAYS];
+    int opened = 0, count = 0;
+    int ok = 1;
+    char path[1024];
+
+    for (; opened < ways; opened++) {
+        file_path(path, sizeof(path), bfs, "run", first + opened);
+        if (!stream_open(&runs[opened], path, "rb")) {
+            ok = 0;
+            break;
+        }
+        if (stream_get(&runs[opened], &heads[opened])) {
+            heap[count++] = opened;
+        }
+    }
+    for (int i = count / 2 - 1; i >= 0; i--) {
+        sift_down(heap, count, heads, i);
+    }
+
+    uint64_t excluded = 0;
+    int has_excluded = exclude && stream_get(exclude, &excluded);
+    int has_last = 0;
+    uint64_t last = 0;
+    while (ok && count > 0) {
+        int top = heap[0];
+        uint64_t rank = heads[top];
+
+        if (!has_last || rank != last) {
+            while (has_excluded && excluded < rank) {
+                has_excluded = stream_get(exclude, &excluded);
+            }
+            if (!has_excluded || excluded != rank) {
+                stream_put(out, rank);
+            }
+            last = rank;
+            has_last = 1;
+        }
+        if (!stream_get(&runs[top], &heads[top])) {
+            heap[0] = heap[--count];
+        }
+        sift_down(heap, count, heads, 0);
+    }
+
+    for (int i = 0; i < opened; i++) {
+        bfs->result->bytes_read += runs[i].bytes;
+        ok = stream_close(&runs[i]) && ok;
+        file_path(path, sizeof(path), bfs, "run", first + i);
+        remove(path);
+    }
+    return ok;
+}
+
+// Merge the layer's runs into its file: in passes of DISKBFS_MERGE_WAYS
+// runs while there are more, then minus the layer two back
+static int finish_layer(Bfs *bfs, int depth) {
+    char path[1024];
+    Stream out, previous;
+    int ok = 1;
+
+    while (ok && bfs->next_run - bfs->first_run > DISKBFS_MERGE_WAYS) {
+        file_path(path, sizeof(path), bfs, "run", bfs->next_run);
+        if (!stream_open(&out, path, "wb")) {
+            return 0;
+        }
+        ok = merge_runs(bfs, bfs->first_run, DISKBFS_MERGE_WAYS, &out, NULL);
+        bfs->result->bytes_written += out.bytes;
+        ok = stream_close(&out) && ok;
+        bfs->first_run += DISKBFS_MERGE_WAYS;
+        bfs->next_run++;
+    }
+
+    int exclude = ok && !bfs->visited && depth >= 2;
+    if (exclude) {
+        file_path(path, sizeof(path), bfs, "layer", depth - 2);
+        if (!stream_open(&previous, path, "rb")) {
+            return 0;
+        }
+    }
+    file_path(path, sizeof(path), bfs, "layer", depth);
+    if (ok && stream_open(&out, path, "wb")) {
+        ok = merge_runs(bfs, bfs->first_run, bfs->next_run - bfs->first_run, &out,
+                        exclude ? &previous : NULL);
+        bfs->result->bytes_written += out.bytes;
+        bfs->result->layer_states[depth] = out.count;
+        ok = stream_close(&out) && ok;
+    } else {
+        ok = 0;
+    }
+    if (exclude) {
+        bfs->result->bytes_read += previous.bytes;
+        stream_close(&previous);
+    }
+    bfs->first_run = bfs->next_run;
+    return ok;
+}
+
+// Children of every board in layer depth, into runs
+static int expand_layer(Bfs *bfs, int depth) {
+    int size = bfs->config->size;
+    char path[1024];
+    Stream layer;
+    PackedBoard board;
+    uint64_t rank;
+    int ok = 1;
+
+    file_path(path, sizeof(path), bfs, "layer", depth);
+    if (!stream_open(&layer, path, "rb")) {
+        return 0;
+    }
+    while (ok && stream_get(&layer, &rank)) {
+        unrank_solvable(&board, size, rank);
+        for (int dir = 0; dir < MOVE_COUNT; dir++) {
+            PackedBoard child = board;
+            if (!packed_move(&child, dir)) {
+                continue;
+            }
+            uint64_t child_rank = rank_solvable(&child);
+            if (bfs->visited) {
+                uint8_t bit = (uint8_t)(1u << (child_rank & 7));
+                if (bfs->visited[child_rank >> 3] & bit) {
+                    continue;
+                }
+                bfs->visited[child_rank >> 3] |= bit;
+            }
+            bfs->buffer[bfs->count++] = child_rank;
+            if (bfs->count == bfs->capacity && !spill_run(bfs)) {
+                ok = 0;
+                break;
+            }
+        }
+    }
+    bfs->result->bytes_read += layer.bytes;
+    ok = stream_close(&layer) && ok;
+    return ok && spill_run(bfs);
+}
+
+int diskbfs_run(const DiskBfsConfig *config, DiskBfsResult *result) {
+    size_t memory = config->memory_bytes ? config->memory_bytes : DISKBFS_DEFAULT_BYTES;
+    char path[1024];
+    Bfs bfs;
+
+    memset(result, 0, sizeof(*result));
+    memset(&bfs, 0, sizeof(bfs));
+    if (config->size < 3 || config->size > RANK_MAX_BOARD_SIZE || !config->directory) {
+        return 0;
+    }
+    bfs.config = config;
+    bfs.result = result;
+
+    int cells = config->size * config->size;
+    uint64_t states = rank_count(cells, cells) / 2;
+    uint64_t bitmap_bytes = (states + 7) / 8;
+    if (bitmap_bytes <= memory / 2) {
+        bfs.visited = calloc((size_t)bitmap_bytes, 1);
+        if (!bfs.visited) {
+            return 0;
+        }
+        memory -= (size_t)bitmap_bytes;
+        result->used_bitmap = 1;
+    }
+    bfs.capacity = memory / sizeof(uint64_t);
+    if (bfs.capacity < MIN_BUFFER_STATES) {
+        bfs.capacity = MIN_BUFFER_STATES;
+    }
+    bfs.buffer = malloc(bfs.capacity * sizeof(uint64_t));
+    if (!bfs.buffer) {
+        free(bfs.visited);
+        return 0;
+    }
+
+    // Layer 0: the goal
+    PackedBoard goal;
+    packed_init(&goal, config->size);
+    bfs.buffer[bfs.count++] = rank_solvable(&goal);
+    if (bfs.visited) {
+        bfs.visited[bfs.buffer[0] >> 3] |= (uint8_t)(1u << (bfs.buffer[0] & 7));
+    }
+    int ok = spill_run(&bfs) && finish_layer(&bfs, 0);
+
+    int depth = 0;
+    while (ok) {
+        uint64_t count = result->layer_states[depth];
+        result->states += count;
+        result->depth_count = depth + 1;
+        if (config->log) {
+            fprintf(config->log, "  depth %3d: %llu states (%llu so far, %llu run files)\n", depth,
+                    (unsigned long long)count, (unsigned long long)result->states,
+                    (unsigned long long)result->runs);
+            fflush(config->log);
+        }
+
+        if (count == 0 || depth + 1 >= DISKBFS_MAX_DEPTH ||
+            (config->max_depth > 0 && depth >= config->max_depth)) {
+            break;
+        }
+        ok = expand_layer(&bfs, depth) && finish_layer(&bfs, depth + 1);
+        if (depth >= 1) {
+            file_path(path, sizeof(path), &bfs, "layer", depth - 1);
+            remove(path);
+        }
+        depth++;
+    }
+    // The last layer found is empty once the space is exhausted
+    if (ok && result->layer_states[depth] == 0) {
+        result->depth_count = depth;
+        result->complete = result->states == states;
+    }
+
+    for (int i = depth - 1; i <= depth; i++) {
+        if (i >= 0) {
+            file_path(path, sizeof(path), &bfs, "layer", i);
+            remove(path);
+        }
+    }
+    for (int i = bfs.first_run; i < bfs.next_run; i++) {
+        file_path(path, sizeof(path), &bfs, "run", i);
+        remove(path);
+    }
+    free(bfs.visited);
+    free(bfs.buffer);
+    return ok;
+}
@@ -0,0 +1,55 @@
+#ifndef DISKBFS_H
+#define DISKBFS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Exhaustive breadth-first search over every solvable board of one size,
+// outward from the goal, for exact distance histograms of spaces far larger
+// than memory. Layers live on disk as sorted rank_solvable() values,
+// delta-coded as varints (about a byte per state once layers are dense),
+// and are only ever read and written sequentially. Expanding a layer fills
+// a memory buffer with child ranks; each time it is full it is sorted and
+// spilled as a run file, and the runs are merged into the next layer.
+//
+// Duplicates are dropped by a visited bitmap indexed by rank when the whole
+// space's bitmap fits in half the memory budget (3x3: 22 KB). Otherwise
+// (4x4: 1.3 TB) the merge drops them: moves alternate the empty cell's
+// colour on a checkerboard, so a layer's children lie only in the layer
+// before or the layer after, and the next layer is the merged children
+// minus the previous layer.
+
+// Deepest layer recorded (the 4x4 diameter is 80 moves)
+#define DISKBFS_MAX_DEPTH 128
+
+// Run files merged at once; more are merged in passes
+#define DISKBFS_MERGE_WAYS 64
+
+// Default memory budget
+#define DISKBFS_DEFAULT_BYTES ((size_t)1 << 30)
+
+typedef struct {
+    int size;               // 3 or 4 (rank_solvable's range)
+    const char *directory;  // Existing directory for layer and run files
+    size_t memory_bytes;    // Visited bitmap plus sort buffer (0: default)
+    int max_depth;          // Last layer to produce (0: until the space is exhausted)
+    FILE *log;              // One line per layer, optional
+} DiskBfsConfig;
+
+typedef struct {
+    int depth_count;                             // Layers produced
+    uint64_t layer_states[DISKBFS_MAX_DEPTH];
+    uint64_t states;                             // Over every layer
+    int used_bitmap;
+    int complete;                                // Every state reached
+    uint64_t runs;                               // Run files spilled
+    uint64_t bytes_written;
+    uint64_t bytes_read;
+} DiskBfsResult;
+
+// Returns 0 on bad settings, out of memory or an I/O error; the files are
+// removed either way
+int diskbfs_run(const DiskBfsConfig *config, DiskBfsResult *result);
+
+#endif // DISKBFS_H
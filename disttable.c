@@ -0,0 +1,195 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "disttable.h"
+#include "pdb.h"
+
+static const char dist_magic[8] = {'T', 'Q', 'D', 'I', 'S', 'T', 0, 0};
+
+static uint64_t header_checksum(const DistFileHeader *header) {
+    return pdb_checksum(header, offsetof(DistFileHeader, header_checksum), 0);
+}
+
+int dist_build(DistTable *table, int size) {
+    if (size != DIST_BOARD_SIZE) {
+        return 0;
+    }
+
+    uint64_t states = rank_count(size * size, size * size) / 2;
+    uint8_t *distances = malloc((size_t)states);
+    uint32_t *queue = malloc((size_t)states * sizeof(uint32_t));
+    if (!distances || !queue) {
+        free(distances);
+        free(queue);
+        return 0;
+    }
+    memset(distances, DIST_UNKNOWN, (size_t)states);
+
+    // Every state enters the queue once, so a flat array is enough
+    PackedBoard board;
+    packed_init(&board, size);
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    queue[tail++] = (uint32_t)rank_solvable(&board);
+    distances[queue[0]] = 0;
+
+    while (head < tail) {
+        uint32_t index = queue[head++];
+        unrank_solvable(&board, size, index);
+
+        for (int dir = 0; dir < MOVE_COUNT; dir++) {
+            PackedBoard child = board;
+            if (!packed_move(&child, dir)) {
+                continue;
+            }
+            uint32_t child_index = (uint32_t)rank_solvable(&child);
+            if (distances[child_index] == DIST_UNKNOWN) {
+                distances[child_index] = (uint8_t)(distances[index] + 1);
+                queue[tail++] = child_index;
+            }
+        }
+    }
+    free(queue);
+
+    if (tail != states) {
+        free(distances);
+        return 0;
+    }
+    table->size = size;
+    table->states = states;
+    table->distances = distances;
+    return 1;
+}
+
+int dist_load(DistTable *table, const char *path) {
+    DistFileHeader header;
+    FILE *file = fopen(path, "rb");
+
+    memset(table, 0, sizeof(*table));
+    if (!file) {
+        return 0;
+    }
+
+    int ok = fread(&header, sizeof(header), 1, file) == 1 &&
+             memcmp(header.magic, dist_magic, sizeof(dist_magic)) == 0 &&
+             header.version == DIST_FILE_VERSION &&
+             header.header_checksum == header_checksum(&header) &&
+             header.board_size == DIST_BOARD_SIZE &&
+             header.states == rank_count(DIST_BOARD_SIZE * DIST_BOARD_SIZE,
+                                         DIST_BOARD_SIZE * DIST_BOARD_SIZE) / 2;
+    if (ok) {
+        table->distances = malloc((size_t)header.states);
+        ok = table->distances &&
+             fread(table->distances, 1, (size_t)header.states, file) == (size_t)header.states &&
+             pdb_checksum(table->distances, (size_t)header.states, 0) == header.payload_checksum;
+    }
+    fclose(file);
+
+    if (!ok) {
+        fprintf(stderr, "Invalid distance table: %s\n", path);
+        dist_free(table);
+        return 0;
+    }
+    table->size = (int)header.board_size;
+    table->states = header.states;
+    return 1;
+}
+
+int dist_write(const DistTable *table, const char *path) {
+    DistFileHeader header;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, dist_magic, sizeof(dist_magic));
+    header.version = DIST_FILE_VERSION;
+    header.board_size = (uint32_t)table->size;
+    header.states = table->states;
+    header.max_distance = (uint64_t)dist_max(table);
+    header.payload_checksum = pdb_checksum(table->distances, (size_t)table->states, 0);
+    header.header_checksum = header_checksum(&header);
+
+    // Write beside the target and rename so a crash never leaves a torn file
+    char temp_path[1024];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE *file = fopen(temp_path, "wb");
+    if (!file) {
+        return 0;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(table->distances, 1, (size_t)table->states, file) == (size_t)table->states;
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok) {
+#ifdef _WIN32
+        remove(path);
+#endif
+        ok = rename(temp_path, path) == 0;
+    }
+    if (!ok) {
+        remove(temp_path);
+    }
+    return ok;
+}
+
+void dist_free(DistTable *table) {
+    free(table->distances);
+    memset(table, 0, sizeof(*table));
+}
+
+int dist_verify(const DistTable *table) {
+    PackedBoard board;
+
+    packed_init(&board, table->size);
+    if (table->distances[rank_solvable(&board)] != 0) {
+        return 0;
+    }
+
+    for (uint64_t index = 0; index < table->states; index++) {
+        int distance = table->distances[index];
+        int closer = 0;
+
+        if (distance == DIST_UNKNOWN) {
+            return 0;
+        }
+        unrank_solvable(&board, table->size, index);
+        for (int dir = 0; dir < MOVE_COUNT; dir++) {
+            PackedBoard child = board;
+            if (!packed_move(&child, dir)) {
+                continue;
+            }
+            int child_distance = dist_lookup(table, &child);
+            if (child_distance != distance - 1 && child_distance != distance + 1) {
+                return 0;
+            }
+            closer |= child_distance == distance - 1;
+        }
+        if (distance > 0 && !closer) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int dist_max(const DistTable *table) {
+    int max = 0;
+
+    for (uint64_t index = 0; index < table->states; index++) {
+        if (table->distances[index] > max) {
+            max = table->distances[index];
+        }
+    }
+    return max;
+}
+
+int dist_best_move(const DistTable *table, const PackedBoard *pb) {
+    int distance = dist_lookup(table, pb);
+
+    for (int dir = 0; distance > 0 && dir < MOVE_COUNT; dir++) {
+        PackedBoard child = *pb;
+        if (packed_move(&child, dir) && dist_lookup(table, &child) == distance - 1) {
+            return dir;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,54 @@
+#ifndef DISTTABLE_H
+#define DISTTABLE_H
+
+#include <stdint.h>
+#include "bitboard.h"
+#include "rank.h"
+
+// Exact distance tables cover every solvable state, so only 3x3 fits
+#define DIST_BOARD_SIZE 3
+#define DIST_FILE_VERSION 1
+#define DIST_UNKNOWN 0xFF
+
+// Optimal move count of every solvable board, one byte per state,
+// indexed by rank_solvable() (181,440 entries for 3x3)
+typedef struct {
+    int size;
+    uint64_t states;
+    uint8_t *distances;
+} DistTable;
+
+// On-disk header (little-endian, distances follow immediately)
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t board_size;
+    uint64_t states;
+    uint64_t max_distance;
+    uint64_t payload_checksum;
+    uint64_t header_checksum;
+} DistFileHeader;
+
+// Breadth-first search back from the goal over the dense state index
+int dist_build(DistTable *table, int size);
+
+// Read a table file, checking both checksums; writes go through a temp file
+int dist_load(DistTable *table, const char *path);
+int dist_write(const DistTable *table, const char *path);
+void dist_free(DistTable *table);
+
+// Full consistency check: the goal is 0, every move changes the distance by
+// exactly one and every other state has a neighbour one closer, which holds
+// only for true optimal distances
+int dist_verify(const DistTable *table);
+int dist_max(const DistTable *table);
+
+// Optimal moves left for a board of the table's size
+static inline int dist_lookup(const DistTable *table, const PackedBoard *pb) {
+    return table->distances[rank_solvable(pb)];
+}
+
+// Direction of an optimal move for the empty tile, -1 if already solved
+int dist_best_move(const DistTable *table, const PackedBoard *pb);
+
+#endif // DISTTABLE_H
@@ -12,6 +12,8 @@
 #include <string.h>
 #include <math.h>
 #include "constant.h"
+#include "solver.h"
+#include "disttable.h"
 
 // Error handling
 void SDL_ExitWithError(const char *message);
@@ -21,6 +23,18 @@ int init_game(void);
 void cleanup_game(void);
 int load_textures(void);
 void free_textures(void);
+void poll_textures(void);
+void load_pattern_databases(void);
+void free_pattern_databases(void);
+const PdbSet *get_pattern_database(int size);
+
+// Texture atlas
+int atlas_load(Atlas *atlas, SDL_Renderer *renderer, const char *pack_path);
+int atlas_poll(Atlas *atlas);
+void atlas_free(Atlas *atlas);
+
+void load_distance_table(void);
+void free_distance_table(void);
 
 // Game logic
 void init_board(int size);
@@ -29,6 +43,19 @@ int is_valid_move(int x, int y);
 int make_move(int x, int y);
 int check_win_condition(void);
 void reset_game(int size);
+int solve_current_board(SolverResult *result);
+int get_optimal_distance(void);
+
+// Background solver (hints and auto-solve)
+void start_solve(SolveMode mode);
+void cancel_solve(void);
+void clear_assist(void);
+void update_solver(void);
+
+// Move log: recording and replay
+void finish_recording(SDL_bool solved);
+int start_replay(uint64_t number);
+void update_replay(void);
 
 // Rendering
 void render_game(void);
@@ -37,6 +64,8 @@ void render_win_screen(void);
 void render_tile(int x, int y, int value);
 void render_background(void);
 void render_ui_elements(void);
+void invalidate_render(void);
+void free_render_cache(void);
 
 // Input handling
 void handle_menu_input(SDL_Event *event);
@@ -46,6 +75,7 @@ void handle_mouse_click(int mouse_x, int mouse_y);
 // Animation
 void update_animations(void);
 void start_tile_animation(int from_x, int from_y, int to_x, int to_y, int tile_value);
+void sync_display(void);
 
 // Utility functions
 void get_empty_position(int *x, int *y);
@@ -54,12 +84,12 @@ void screen_to_board_coords(int screen_x, int screen_y, int *board_x, int *board
 void board_to_screen_coords(int board_x, int board_y, int *screen_x, int *screen_y);
 
 // Statistics and scoring
-void update_stats(void);
 void save_best_score(void);
 void load_best_scores(void);
 
 // Settings and configuration
 void load_settings(void);
 void save_settings(void);
+void stop_saving(void);
 
 #endif // FUNCTIONS_H
@@ -3,6 +3,16 @@
 // Global game instance
 GameData game = {0};
 
+// Pattern databases mapped at startup, indexed by board size
+static PdbSet pattern_databases[MAX_BOARD_SIZE + 1];
+
+// Exact distances for every 3x3 state, loaded or built at startup
+#define DIST_TABLE_PATH "data/dist-3x3.bin"
+static DistTable distance_table;
+
+// Scratch memory of the background solves, one at a time, kept between them
+static Arena solve_arena;
+
 // Error handling
 void SDL_ExitWithError(const char *message) {
     SDL_Log("ERROR: %s > %s\n", message, SDL_GetError());
@@ -19,7 +29,7 @@ int init_game(void) {
     }
 
     // Create window
-    game.window = SDL_CreateWindow("Taquin - Sliding Puzzle",
+    game.window = SDL_CreateWindow(WINDOW_TITLE,
                                    SDL_WINDOWPOS_CENTERED,
                                    SDL_WINDOWPOS_CENTERED,
                                    WINDOW_WIDTH, WINDOW_HEIGHT,
@@ -41,6 +51,13 @@ int init_game(void) {
     game.state = GAME_STATE_MENU;
     game.board_size = 3;
     game.is_animating = SDL_FALSE;
+
+    // Seed the shuffle generator
+    if (game.seed == 0) {
+        game.seed = (uint64_t)time(NULL) ^ SDL_GetPerformanceCounter();
+    }
+    rng_seed(&game.rng, game.seed);
+    printf("Seed: %llu\n", (unsigned long long)game.seed);
     
     // Initialize stats
     memset(&game.stats, 0, sizeof(GameStats));
@@ -56,12 +73,30 @@ int init_game(void) {
     
     load_settings();
     load_best_scores();
+    load_pattern_databases();
+    load_distance_table();
+    if (!movelog_writer_open(&game.log, MOVELOG_PATH)) {
+        fprintf(stderr, "Cannot open %s, games will not be recorded\n", MOVELOG_PATH);
+    }
     
     return 1;
 }
 
 void cleanup_game(void) {
+    cancel_solve();
+    arena_free(&solve_arena);
+    stop_saving();
+    finish_recording(SDL_FALSE);
+    movelog_writer_close(&game.log);
+    movelog_game_free(&game.record);
+    movelog_game_free(&game.replay);
+    move_plan_free(&game.autoplay_plan);
+    free_render_cache();
     free_textures();
+    free_pattern_databases();
+    free_distance_table();
+    board_free(&game.board);
+    board_free(&game.display);
     
     if (game.renderer) {
         SDL_DestroyRenderer(game.renderer);
@@ -76,122 +111,130 @@ void cleanup_game(void) {
     SDL_Quit();
 }
 
+// Tile and interface images stream into the atlas from the asset pack;
+// tiles are drawn plain until their image arrives
 int load_textures(void) {
-    // Load number textures
-    for (int i = 0; i < MAX_TEXTURES - 1; i++) {
-        char filename[64];
-        snprintf(filename, sizeof(filename), "images/numbers/N%d.bmp", i + 1);
-        
-        SDL_Surface* surface = SDL_LoadBMP(filename);
-        if (!surface) {
-            fprintf(stderr, "Failed to load %s: %s\n", filename, SDL_GetError());
-            continue;
-        }
-        
-        game.number_textures[i] = SDL_CreateTextureFromSurface(game.renderer, surface);
-        SDL_FreeSurface(surface);
-        
-        if (!game.number_textures[i]) {
-            fprintf(stderr, "Failed to create texture from %s: %s\n", filename, SDL_GetError());
-            return 0;
-        }
-    }
-    
-    // Load UI textures
-    const char* ui_files[] = {
-        "images/inteface/1.bmp",
-        "images/inteface/2.bmp", 
-        "images/inteface/3.bmp",
-        "images/inteface/4.bmp",
-        "images/inteface/5.bmp"
-    };
-    
-    for (int i = 0; i < 5; i++) {
-        SDL_Surface* surface = SDL_LoadBMP(ui_files[i]);
-        if (surface) {
-            game.ui_textures[i] = SDL_CreateTextureFromSurface(game.renderer, surface);
-            SDL_FreeSurface(surface);
-        }
+    if (!atlas_load(&game.atlas, game.renderer, ASSET_PACK_PATH)) {
+        fprintf(stderr, "Failed to load textures, drawing plain tiles\n");
     }
-    
     return 1;
 }
 
 void free_textures(void) {
-    // Free number textures
-    for (int i = 0; i < MAX_TEXTURES; i++) {
-        if (game.number_textures[i]) {
-            SDL_DestroyTexture(game.number_textures[i]);
-            game.number_textures[i] = NULL;
-        }
+    atlas_free(&game.atlas);
+}
+
+// Called every frame while images are still arriving
+void poll_textures(void) {
+    if (atlas_poll(&game.atlas) > 0) {
+        free_render_cache();  // Redraw tiles drawn plain so far
     }
-    
-    // Free UI textures
-    for (int i = 0; i < 6; i++) {
-        if (game.ui_textures[i]) {
-            SDL_DestroyTexture(game.ui_textures[i]);
-            game.ui_textures[i] = NULL;
+}
+
+// Map whichever precomputed databases exist; larger sets take priority
+void load_pattern_databases(void) {
+    static const struct {
+        int size;
+        const char *path;
+    } files[] = {
+        {4, "data/pdb-4x4-7-8.bin"},
+        {4, "data/pdb-4x4-6-6-3.bin"},
+        {5, "data/pdb-5x5-6-6-6-6.bin"}
+    };
+
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        PdbSet *set = &pattern_databases[files[i].size];
+        if (!set->file.data && pdb_open(set, files[i].path)) {
+            printf("Loaded pattern database %s\n", files[i].path);
         }
     }
 }
 
+void free_pattern_databases(void) {
+    for (int size = 0; size <= MAX_BOARD_SIZE; size++) {
+        pdb_close(&pattern_databases[size]);
+    }
+}
+
+const PdbSet *get_pattern_database(int size) {
+    if (size < 0 || size > MAX_BOARD_SIZE || !pattern_databases[size].file.data) {
+        return NULL;
+    }
+    return &pattern_databases[size];
+}
+
+// Without a table file (make tables), build it now and cache it for next time
+void load_distance_table(void) {
+    if (dist_load(&distance_table, DIST_TABLE_PATH)) {
+        printf("Loaded distance table %s\n", DIST_TABLE_PATH);
+        return;
+    }
+    if (!dist_build(&distance_table, DIST_BOARD_SIZE)) {
+        fprintf(stderr, "Failed to build the 3x3 distance table\n");
+        return;
+    }
+    if (dist_write(&distance_table, DIST_TABLE_PATH)) {
+        printf("Built distance table %s\n", DIST_TABLE_PATH);
+    }
+}
+
+void free_distance_table(void) {
+    dist_free(&distance_table);
+}
+
+// Optimal moves left on the current board, -1 when no table covers its size
+int get_optimal_distance(void) {
+    PackedBoard board;
+
+    if (game.board_size != DIST_BOARD_SIZE || !distance_table.distances ||
+        !board_to_packed(&game.board, &board)) {
+        return -1;
+    }
+    return dist_lookup(&distance_table, &board);
+}
+
 // Game logic functions
 void init_board(int size) {
-    game.board_size = size;
+    clear_assist();
     
     // Initialize board in solved state
-    int value = 1;
-    for (int y = 0; y < size; y++) {
-        for (int x = 0; x < size; x++) {
-            if (x == size - 1 && y == size - 1) {
-                game.board[x][y] = 0;  // Empty tile
-                game.empty_x = x;
-                game.empty_y = y;
-            } else {
-                game.board[x][y] = value++;
-            }
-        }
+    if (!board_init(&game.board, size)) {
+        SDL_ExitWithError("Failed to allocate the board");
     }
+    game.board_size = size;
     
+    game.win_pending = SDL_FALSE;
+    sync_display();
+
     // Reset stats
     game.stats.moves = 0;
     game.stats.time_seconds = 0;
+    game.stats.play_ticks = 0;
 }
 
+// Replace the board with a uniformly random solvable arrangement. Each
+// shuffle gets its own seed from the master stream so it can be replayed.
 void shuffle_board(void) {
-    srand((unsigned int)time(NULL));
-    
-    int empty_x = game.empty_x;
-    int empty_y = game.empty_y;
-    
-    // Perform random valid moves to shuffle
-    for (int i = 0; i < SHUFFLE_MOVES; i++) {
-        int direction = rand() % 4;
-        int new_x = empty_x;
-        int new_y = empty_y;
-        
-        switch (direction) {
-            case 0: new_x--; break;  // Left
-            case 1: new_x++; break;  // Right
-            case 2: new_y--; break;  // Up
-            case 3: new_y++; break;  // Down
-        }
-        
-        // Check if move is valid
-        if (new_x >= 0 && new_x < game.board_size && 
-            new_y >= 0 && new_y < game.board_size) {
-            
-            // Swap tiles
-            game.board[empty_x][empty_y] = game.board[new_x][new_y];
-            game.board[new_x][new_y] = 0;
-            
-            empty_x = new_x;
-            empty_y = new_y;
-        }
-    }
-    
-    game.empty_x = empty_x;
-    game.empty_y = empty_y;
+    Rng board_rng;
+
+    clear_assist();
+    do {
+        game.board_seed = rng_next(&game.rng);
+        rng_seed(&board_rng, game.board_seed);
+        boardgen_board(&game.board, game.board_size, &board_rng);
+    } while (board_is_solved(&game.board));
+
+    sync_display();
+
+    // A new shuffle is a new game; the one before is logged unfinished
+    finish_recording(SDL_FALSE);
+    game.record.flags = 0;
+    game.recording = game.log.file && movelog_game_begin(&game.record, &game.board, game.board_seed);
+
+    // Moves and time count from here, for the leaderboards and the next log entry
+    game.stats.moves = 0;
+    game.stats.time_seconds = 0;
+    game.stats.play_ticks = 0;
 }
 
 int is_valid_move(int x, int y) {
@@ -199,15 +242,8 @@ int is_valid_move(int x, int y) {
         return 0;
     }
     
-    if (game.board[x][y] == 0) {
-        return 0;  // Can't move empty tile
-    }
-    
-    // Check if adjacent to empty tile
-    int dx = abs(x - game.empty_x);
-    int dy = abs(y - game.empty_y);
-    
-    return (dx == 1 && dy == 0) || (dx == 0 && dy == 1);
+    // Only tiles next to the empty cell move (never the empty cell itself)
+    return board_adjacent(&game.board, y * game.board_size + x);
 }
 
 int make_move(int x, int y) {
@@ -215,15 +251,19 @@ int make_move(int x, int y) {
         return 0;
     }
     
-    // Start animation
-    start_tile_animation(x, y, game.empty_x, game.empty_y, game.board[x][y]);
-    
-    // Swap tiles
-    game.board[game.empty_x][game.empty_y] = game.board[x][y];
-    game.board[x][y] = 0;
-    
-    game.empty_x = x;
-    game.empty_y = y;
+    // Swap tiles; the slide catches the display up afterwards
+    int cell = y * game.board_size + x;
+    int to_x = game.board.empty % game.board_size;
+    int to_y = game.board.empty / game.board_size;
+    if (game.recording) {
+        game.recording = movelog_game_add(&game.record, board_direction(&game.board, cell));
+    }
+    // Kept even when nothing is logged: assisted games stay off the leaderboards
+    if (game.autoplay) {
+        game.record.flags |= MOVELOG_ASSISTED;
+    }
+    int tile = board_slide(&game.board, cell);
+    start_tile_animation(x, y, to_x, to_y, tile);
     
     game.stats.moves++;
     
@@ -231,29 +271,342 @@ int make_move(int x, int y) {
 }
 
 int check_win_condition(void) {
-    int expected = 1;
-    
-    for (int y = 0; y < game.board_size; y++) {
-        for (int x = 0; x < game.board_size; x++) {
-            if (x == game.board_size - 1 && y == game.board_size - 1) {
-                // Last tile should be empty
-                if (game.board[x][y] != 0) {
-                    return 0;
-                }
-            } else {
-                if (game.board[x][y] != expected) {
-                    return 0;
-                }
-                expected++;
-            }
+    return board_is_solved(&game.board);
+}
+
+// Solution for a board; 3x3 boards follow the distance table
+// downhill, no search needed
+static int solve_board(PackedBoard *start, const SolverConfig *config, SolverResult *result) {
+    if (start->size == DIST_BOARD_SIZE && distance_table.distances) {
+        int dir;
+        memset(result, 0, sizeof(*result));
+        result->status = SOLVER_SOLVED;
+        while ((dir = dist_best_move(&distance_table, start)) >= 0) {
+            packed_move(start, dir);
+            result->moves[result->length++] = (uint8_t)dir;
+        }
+        return 1;
+    }
+    return solver_solve_with(start, config, result);
+}
+
+// Optimal IDA* up to 4x4; optimal 5x5 solutions can take hours, so 5x5
+// settles for a near-optimal bidirectional search that takes seconds
+static void configure_solver(SolverConfig *config, int threads) {
+    config->pdb = get_pattern_database(game.board_size);
+    config->threads = threads;
+    if (game.board_size == PACKED_MAX_SIZE) {
+        config->engine = SOLVER_ENGINE_BIDIRECTIONAL;
+        config->weight = SOLVE_WEIGHT_5X5;
+    }
+}
+
+// Solution for the board currently on screen
+int solve_current_board(SolverResult *result) {
+    PackedBoard start;
+    SolverConfig config = {0};
+
+    if (!board_to_packed(&game.board, &start)) {
+        return 0;
+    }
+    configure_solver(&config, SDL_GetCPUCount());
+    return solve_board(&start, &config, result);
+}
+
+// Background solves: at most one job, owned by the main thread. Whenever
+// the board changes the job is cancelled and joined, which takes at most a
+// few thousand search nodes. Hints from 5x5 up and every solve above 5x5
+// use the row/column reduction, which answers in milliseconds.
+typedef struct {
+    Board start;
+    PackedBoard board;  // Solver's working copy
+    SolveMode mode;
+    SDL_bool reduce;
+    SolverConfig config;
+    SolverControl control;
+    SolverResult result;
+    MovePlan plan;      // Either engine's solution
+    SDL_bool solved;
+    SDL_atomic_t done;
+    SDL_Thread *thread;
+} SolveJob;
+
+static SolveJob *solve_job = NULL;
+
+static void free_job(SolveJob *job) {
+    board_free(&job->start);
+    move_plan_free(&job->plan);
+    free(job);
+}
+
+static int solve_thread(void *data) {
+    SolveJob *job = data;
+
+    PROFILE_BEGIN(PROFILE_SOLVE);
+    if (job->reduce) {
+        job->solved = reduce_solve(&job->start, 1, &job->control, &job->plan);
+    } else if (solve_board(&job->board, &job->config, &job->result)) {
+        job->plan.moves = malloc(SOLVER_MAX_MOVES);
+        if (job->plan.moves) {
+            memcpy(job->plan.moves, job->result.moves, (size_t)job->result.length);
+            job->plan.length = (size_t)job->result.length;
+            job->plan.capacity = SOLVER_MAX_MOVES;
+            job->solved = SDL_TRUE;
+        }
+    }
+    PROFILE_END(PROFILE_SOLVE);
+    PROFILE_THREAD_EXIT();
+    SDL_AtomicSet(&job->done, 1);
+    return 0;
+}
+
+void start_solve(SolveMode mode) {
+    int cpus = SDL_GetCPUCount();
+    SolveJob *job;
+
+    cancel_solve();
+    job = calloc(1, sizeof(SolveJob));
+    if (!job || !board_copy(&job->start, &game.board)) {
+        free(job);
+        return;
+    }
+    job->mode = mode;
+    job->reduce = game.board_size > PACKED_MAX_SIZE ||
+                  (mode == SOLVE_HINT && game.board_size == PACKED_MAX_SIZE);
+    if (!job->reduce) {
+        board_to_packed(&game.board, &job->board);
+        configure_solver(&job->config, cpus > 1 ? cpus - 1 : 1);  // Leave a core for rendering
+        job->config.control = &job->control;
+        job->config.arena = &solve_arena;
+    }
+
+    job->thread = SDL_CreateThread(solve_thread, "solver", job);
+    if (!job->thread) {
+        fprintf(stderr, "Failed to start solver thread: %s\n", SDL_GetError());
+        free_job(job);
+        return;
+    }
+    solve_job = job;
+    game.solving = SDL_TRUE;
+}
+
+void cancel_solve(void) {
+    if (!solve_job) {
+        return;
+    }
+    solver_cancel(&solve_job->control);
+    SDL_WaitThread(solve_job->thread, NULL);
+    free_job(solve_job);
+    solve_job = NULL;
+    game.solving = SDL_FALSE;
+}
+
+// Drop any search, hint or playback tied to the current board
+void clear_assist(void) {
+    if (game.solving || game.hint_shown || game.autoplay || game.replaying) {
+        SDL_SetWindowTitle(game.window, WINDOW_TITLE);
+    }
+    cancel_solve();
+    game.hint_shown = SDL_FALSE;
+    game.autoplay = SDL_FALSE;
+    game.replaying = SDL_FALSE;
+}
+
+static void finish_solve(SolveJob *job) {
+    char title[128];
+
+    // The board should not have changed, but never act on a stale answer
+    if (!job->solved || job->start.size != game.board.size ||
+        memcmp(job->start.tiles, game.board.tiles,
+               (size_t)game.board.cells * sizeof(game.board.tiles[0])) != 0) {
+        SDL_SetWindowTitle(game.window, WINDOW_TITLE);
+        return;
+    }
+
+    if (job->reduce) {
+        snprintf(title, sizeof(title), "%s - %zu moves to solve (at least %d)", WINDOW_TITLE,
+                 job->plan.length, job->plan.lower_bound);
+    } else {
+        snprintf(title, sizeof(title), "%s - %zu moves to solve", WINDOW_TITLE, job->plan.length);
+    }
+    SDL_SetWindowTitle(game.window, title);
+    if (job->plan.length == 0) {
+        return;
+    }
+
+    if (job->mode == SOLVE_HINT) {
+        int cell = board_neighbor(&job->start, job->plan.moves[0]);
+        game.hint_x = cell % game.board_size;
+        game.hint_y = cell / game.board_size;
+        game.hint_shown = SDL_TRUE;
+        game.record.flags |= MOVELOG_ASSISTED;
+    } else {
+        // The job's plan becomes the one played back
+        move_plan_free(&game.autoplay_plan);
+        game.autoplay_plan = job->plan;
+        memset(&job->plan, 0, sizeof(job->plan));
+        game.autoplay_index = 0;
+        game.autoplay = SDL_TRUE;
+    }
+}
+
+// Called every frame while playing: report progress, collect finished
+// searches and keep one auto-solve move queued behind the moving one
+void update_solver(void) {
+    static Uint32 last_progress = 0;
+
+    if (solve_job && !SDL_AtomicGet(&solve_job->done)) {
+        Uint32 now = SDL_GetTicks();
+        if (now - last_progress >= SOLVE_PROGRESS_INTERVAL) {
+            char title[128];
+            int bound;
+            uint64_t nodes;
+
+            solver_progress(&solve_job->control, &bound, &nodes);
+            snprintf(title, sizeof(title), "%s - Solving: depth %d, %.1fM nodes",
+                     WINDOW_TITLE, bound, (double)nodes / 1e6);
+            SDL_SetWindowTitle(game.window, title);
+            last_progress = now;
+        }
+    } else if (solve_job) {
+        SolveJob *job = solve_job;
+        SDL_WaitThread(job->thread, NULL);
+        solve_job = NULL;
+        game.solving = SDL_FALSE;
+        finish_solve(job);
+        free_job(job);
+    }
+
+    if (game.autoplay && game.slide_count < 2) {
+        static const int dx[MOVE_COUNT] = {-1, 1, 0, 0};
+        static const int dy[MOVE_COUNT] = {0, 0, -1, 1};
+
+        if (game.autoplay_index >= game.autoplay_plan.length) {
+            game.autoplay = SDL_FALSE;
+            return;
+        }
+        int dir = game.autoplay_plan.moves[game.autoplay_index++];
+        make_move(game.board.empty % game.board_size + dx[dir],
+                  game.board.empty / game.board_size + dy[dir]);
+
+        // Auto-solved games are not scored
+        if (check_win_condition()) {
+            game.autoplay = SDL_FALSE;
+            game.win_pending = SDL_TRUE;
+            finish_recording(SDL_TRUE);
         }
     }
-    
-    return 1;
 }
 
 void reset_game(int size) {
     init_board(size);
     shuffle_board();
     game.state = GAME_STATE_PLAYING;
+
+    if (game.scores.settings.board_size != (uint32_t)size) {
+        game.scores.settings.board_size = (uint32_t)size;
+        save_settings();
+    }
+}
+
+// Move log
+// The game in progress is recorded move by move and appended to the log
+// when it is won or abandoned; games with no moves are not kept. Each game
+// is written out as a block of its own at once, so a crash loses at most
+// the game being played.
+void finish_recording(SDL_bool solved) {
+    if (!game.recording) {
+        return;
+    }
+    game.recording = SDL_FALSE;
+    if (game.record.move_count == 0) {
+        return;
+    }
+
+    game.record.flags |= solved ? MOVELOG_SOLVED : 0;
+    game.record.duration_ms = (uint32_t)(game.stats.play_ticks * 1000 / SDL_GetPerformanceFrequency());
+    if (!movelog_writer_append(&game.log, &game.record) || !movelog_writer_flush(&game.log)) {
+        fprintf(stderr, "Failed to write to %s\n", MOVELOG_PATH);
+    }
+}
+
+// Play a logged game back from its start board (UINT64_MAX for the latest)
+int start_replay(uint64_t number) {
+    MoveLogIndex index;
+    MoveLogReader reader;
+    char title[128];
+
+    // The log only holds what has been written out
+    finish_recording(SDL_FALSE);
+    if (game.log.file) {
+        movelog_writer_flush(&game.log);
+    }
+
+    if (!movelog_index(&index, MOVELOG_PATH)) {
+        fprintf(stderr, "No move log at %s\n", MOVELOG_PATH);
+        return 0;
+    }
+    if (number == UINT64_MAX && index.games > 0) {
+        number = index.games - 1;
+    }
+    int ok = movelog_reader_open(&reader, MOVELOG_PATH);
+    if (ok) {
+        ok = movelog_reader_seek(&reader, &index, number) &&
+             movelog_reader_next(&reader, &game.replay);
+        if (!ok && reader.damaged) {
+            fprintf(stderr, "Game %llu is in a damaged block of %s\n", (unsigned long long)number,
+                    MOVELOG_PATH);
+            movelog_reader_close(&reader);
+            movelog_index_free(&index);
+            return 0;
+        }
+        movelog_reader_close(&reader);
+    }
+    if (!ok) {
+        fprintf(stderr, "No game %llu in %s (%llu games)\n", (unsigned long long)number,
+                MOVELOG_PATH, (unsigned long long)index.games);
+        movelog_index_free(&index);
+        return 0;
+    }
+    movelog_index_free(&index);
+
+    clear_assist();
+    if (!board_copy(&game.board, &game.replay.start)) {
+        SDL_ExitWithError("Failed to allocate the board");
+    }
+    game.board_size = game.board.size;
+    game.win_pending = SDL_FALSE;
+    game.stats.moves = 0;
+    game.stats.time_seconds = 0;
+    game.stats.play_ticks = 0;
+    sync_display();
+    game.replaying = SDL_TRUE;
+    game.replay_index = 0;
+    game.state = GAME_STATE_PLAYING;
+
+    snprintf(title, sizeof(title), "%s - Replay of game %llu, %zu moves", WINDOW_TITLE,
+             (unsigned long long)number, game.replay.move_count);
+    SDL_SetWindowTitle(game.window, title);
+    return 1;
+}
+
+// Called every simulation step; keeps one replayed move queued behind the
+// moving one, like auto-solve
+void update_replay(void) {
+    if (!game.replaying || game.slide_count >= 2) {
+        return;
+    }
+    if (game.replay_index >= game.replay.move_count) {
+        game.replaying = SDL_FALSE;
+        game.win_pending = check_win_condition();
+        return;
+    }
+
+    int cell = board_neighbor(&game.board, game.replay.moves[game.replay_index++]);
+    if (cell < 0) {
+        fprintf(stderr, "Replayed move %zu leaves the board\n", game.replay_index);
+        game.replaying = SDL_FALSE;
+        return;
+    }
+    make_move(cell % game.board_size, cell / game.board_size);
 }
@@ -0,0 +1,119 @@
+/**
+ * Taquin - Board Generator
+ *
+ * Prints uniformly random solvable boards, one per line in the format
+ * taquin-solve reads, from an explicit seed so runs are reproducible.
+ * Boards can be restricted to a heuristic band or a minimum optimal
+ * solution length (up to 5x5); larger boards, up to 32x32, are only
+ * generated. No SDL required.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "board.h"
+#include "boardgen.h"
+#include "pdb.h"
+
+static int usage(void) {
+    fprintf(stderr, "Usage: taquin-gen [-n count] [-s size] [--seed N]\n");
+    fprintf(stderr, "                  [--band min:max] [--min-length L] [-p pdb-file]\n");
+    fprintf(stderr, "  --band keeps boards whose Manhattan + linear-conflict estimate is in range;\n");
+    fprintf(stderr, "  --min-length solves each candidate (use -p to speed up 4x4 and 5x5).\n");
+    return EXIT_FAILURE;
+}
+
+static int print_large(long count, int size, uint64_t seed) {
+    Board board = {0};
+    Rng rng;
+
+    rng_seed(&rng, seed);
+    fprintf(stderr, "# seed %llu\n", (unsigned long long)seed);
+    for (long n = 0; n < count; n++) {
+        if (!boardgen_board(&board, size, &rng)) {
+            return EXIT_FAILURE;
+        }
+        for (int cell = 0; cell < board.cells; cell++) {
+            printf(cell ? " %d" : "%d", board.tiles[cell]);
+        }
+        putchar('\n');
+    }
+    board_free(&board);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    long count = 1;
+    int size = 4;
+    uint64_t seed = (uint64_t)time(NULL);
+    BoardTarget target = {0};
+    const char *pdb_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--band") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d:%d", &target.min_heuristic, &target.max_heuristic) != 2) {
+                return usage();
+            }
+        } else if (strcmp(argv[i], "--min-length") == 0 && i + 1 < argc) {
+            target.min_length = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            pdb_path = argv[++i];
+        } else {
+            return usage();
+        }
+    }
+    if (size < BOARD_MIN_SIZE || size > BOARD_MAX_SIZE || count < 0) {
+        return usage();
+    }
+
+    // Runtime-sized boards: no heuristic or solver filters beyond 5x5
+    if (size > PACKED_MAX_SIZE) {
+        if (target.min_length || target.min_heuristic || target.max_heuristic || pdb_path) {
+            fprintf(stderr, "Targets need a board of %dx%d or smaller\n", PACKED_MAX_SIZE, PACKED_MAX_SIZE);
+            return EXIT_FAILURE;
+        }
+        return print_large(count, size, seed);
+    }
+
+    PdbSet pdb;
+    SolverConfig config = {0};
+    if (pdb_path) {
+        if (!pdb_open(&pdb, pdb_path) || pdb.size != size) {
+            fprintf(stderr, "Cannot use pattern database %s for %dx%d\n", pdb_path, size, size);
+            return EXIT_FAILURE;
+        }
+        config.pdb = &pdb;
+    }
+
+    Rng rng;
+    rng_seed(&rng, seed);
+    fprintf(stderr, "# seed %llu\n", (unsigned long long)seed);
+
+    int ok = 1;
+    for (long n = 0; n < count; n++) {
+        PackedBoard board;
+
+        if (!boardgen_targeted(&board, size, &rng, &target, &config)) {
+            fprintf(stderr, "No board met the target after %d attempts\n",
+                    target.max_attempts > 0 ? target.max_attempts : 100000);
+            ok = 0;
+            break;
+        }
+        for (int cell = 0; cell < size * size; cell++) {
+            printf(cell ? " %d" : "%d", packed_get(&board, cell));
+        }
+        putchar('\n');
+    }
+
+    if (config.pdb) {
+        pdb_close(&pdb);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
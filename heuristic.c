@@ -0,0 +1,366 @@
+#include <pthread.h>
+#include <string.h>
+#include "heuristic.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HEURISTIC_X86 1
+#include <immintrin.h>
+#endif
+
+// Boards per block: byte lanes in the widest kernel
+#define BLOCK_LANES 32
+
+// Per-size lookup tables, indexed by tile (0-31) so a block looks a whole
+// cell up with two 16-byte shuffles
+typedef struct {
+    int size;
+    int cells;
+    uint8_t md[PACKED_MAX_CELLS][32];        // [cell][tile]
+    uint8_t row_code[PACKED_MAX_SIZE][32];   // [row][tile]: goal column, or size if elsewhere
+    uint8_t col_code[PACKED_MAX_SIZE][32];   // [column][tile]: goal row, or size if elsewhere
+    uint16_t place[PACKED_MAX_SIZE];         // Line keys are base-(size + 1) numbers
+    int32_t conflicts[HEURISTIC_LINE_KEYS];  // Penalty per line key (32-bit for gathers)
+} ScoreTables;
+
+static ScoreTables score_tables[PACKED_MAX_SIZE + 1];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+int heuristic_line_penalty(int size, int key) {
+    int goals[PACKED_MAX_SIZE];
+    int lis[PACKED_MAX_SIZE];
+    int count = 0;
+    int longest = 0;
+
+    for (int i = 0; i < size; i++) {
+        int digit = key % (size + 1);
+        key /= size + 1;
+        if (digit < size) {
+            goals[count++] = digit;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        lis[i] = 1;
+        for (int j = 0; j < i; j++) {
+            if (goals[j] < goals[i] && lis[j] + 1 > lis[i]) {
+                lis[i] = lis[j] + 1;
+            }
+        }
+        longest = lis[i] > longest ? lis[i] : longest;
+    }
+    return 2 * (count - longest);
+}
+
+static void build_size(ScoreTables *t, int size) {
+    int cells = size * size;
+
+    memset(t, 0, sizeof(*t));
+    t->size = size;
+    t->cells = cells;
+    for (int tile = 0; tile < 32; tile++) {
+        int valid = tile > 0 && tile < cells;
+        int gx = valid ? (tile - 1) % size : 0;
+        int gy = valid ? (tile - 1) / size : 0;
+        for (int cell = 0; cell < cells; cell++) {
+            int dx = cell % size - gx;
+            int dy = cell / size - gy;
+            t->md[cell][tile] = (uint8_t)(valid ? (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy) : 0);
+        }
+        for (int line = 0; line < size; line++) {
+            t->row_code[line][tile] = (uint8_t)(valid && gy == line ? gx : size);
+            t->col_code[line][tile] = (uint8_t)(valid && gx == line ? gy : size);
+        }
+    }
+
+    int keys = 1;
+    for (int i = 0; i < size; i++) {
+        t->place[i] = (uint16_t)keys;
+        keys *= size + 1;
+    }
+    for (int key = 0; key < keys; key++) {
+        t->conflicts[key] = heuristic_line_penalty(size, key);
+    }
+}
+
+static void build_tables(void) {
+    for (int size = 3; size <= PACKED_MAX_SIZE; size++) {
+        build_size(&score_tables[size], size);
+    }
+}
+
+// Block layout: tiles[cell][lane], one board per lane; lanes past count
+// repeat the last board so kernels never need a tail case
+static void unpack_block(const PackedBoard *boards, size_t count, int lanes,
+                         uint8_t tiles[PACKED_MAX_CELLS][BLOCK_LANES]) {
+    for (int lane = 0; lane < lanes; lane++) {
+        const PackedBoard *pb = &boards[(size_t)lane < count ? (size_t)lane : count - 1];
+        int cells = pb->size * pb->size;
+
+        if (pb->bits == 4) {
+            uint64_t word = pb->words[0];
+            for (int cell = 0; cell < cells; cell++) {
+                tiles[cell][lane] = (uint8_t)(word >> (4 * cell) & 0xF);
+            }
+        } else {
+            for (int cell = 0; cell < cells; cell++) {
+                tiles[cell][lane] = (uint8_t)packed_get(pb, cell);
+            }
+        }
+    }
+}
+
+static void finish_score(StateScore *score, int manhattan, int conflicts, int misplaced) {
+    score->manhattan = (uint16_t)manhattan;
+    score->conflicts = (uint16_t)conflicts;
+    score->misplaced = (uint16_t)misplaced;
+    score->total = (uint16_t)(manhattan + conflicts);
+}
+
+static void score_scalar(const ScoreTables *t, const uint8_t tiles[PACKED_MAX_CELLS][BLOCK_LANES],
+                         int lanes, StateScore *scores) {
+    for (int lane = 0; lane < lanes; lane++) {
+        int row_key[PACKED_MAX_SIZE] = {0};
+        int col_key[PACKED_MAX_SIZE] = {0};
+        int manhattan = 0, misplaced = 0, conflicts = 0;
+
+        for (int cell = 0; cell < t->cells; cell++) {
+            int tile = tiles[cell][lane];
+            int x = cell % t->size;
+            int y = cell / t->size;
+            manhattan += t->md[cell][tile];
+            misplaced += tile != 0 && tile != cell + 1;
+            row_key[y] += t->row_code[y][tile] * t->place[x];
+            col_key[x] += t->col_code[x][tile] * t->place[y];
+        }
+        for (int line = 0; line < t->size; line++) {
+            conflicts += t->conflicts[row_key[line]] + t->conflicts[col_key[line]];
+        }
+        finish_score(&scores[lane], manhattan, conflicts, misplaced);
+    }
+}
+
+#ifdef HEURISTIC_X86
+
+// 16 boards: tables are looked up with pshufb; on 5x5, tiles 16-31 come
+// from the upper half of each table (pshufb only sees the low four bits),
+// picked by blend.
+// Line keys build up in 16-bit lanes; SSE has no gather, so conflicts are
+// read back one key at a time.
+__attribute__((target("ssse3,sse4.1")))
+static void score_sse41(const ScoreTables *t, const uint8_t tiles[PACKED_MAX_CELLS][BLOCK_LANES],
+                        int lanes, StateScore *scores) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fifteen = _mm_set1_epi8(15);
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i manhattan = zero, misplaced = zero;
+    __m128i row_lo[PACKED_MAX_SIZE], row_hi[PACKED_MAX_SIZE];
+    __m128i col_lo[PACKED_MAX_SIZE], col_hi[PACKED_MAX_SIZE];
+    uint16_t keys[16];
+    uint8_t md_out[16], mis_out[16];
+    int conflicts[16] = {0};
+
+    for (int line = 0; line < t->size; line++) {
+        row_lo[line] = row_hi[line] = col_lo[line] = col_hi[line] = zero;
+    }
+
+    int wide = t->cells > 16;
+#define LOOKUP_SSE(table, v, high) \
+    (wide ? _mm_blendv_epi8(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(table)), v), \
+                            _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)((table) + 16)), v), high) \
+          : _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(table)), v))
+
+    for (int cell = 0; cell < t->cells; cell++) {
+        int x = cell % t->size;
+        int y = cell / t->size;
+        __m128i v = _mm_loadu_si128((const __m128i *)tiles[cell]);
+        __m128i high = _mm_cmpgt_epi8(v, fifteen);
+
+        manhattan = _mm_add_epi8(manhattan, LOOKUP_SSE(t->md[cell], v, high));
+        __m128i home = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)(cell + 1))),
+                                    _mm_cmpeq_epi8(v, zero));
+        misplaced = _mm_add_epi8(misplaced, _mm_andnot_si128(home, one));
+
+        __m128i code = LOOKUP_SSE(t->row_code[y], v, high);
+        __m128i place = _mm_set1_epi16((short)t->place[x]);
+        row_lo[y] = _mm_add_epi16(row_lo[y], _mm_mullo_epi16(_mm_unpacklo_epi8(code, zero), place));
+        row_hi[y] = _mm_add_epi16(row_hi[y], _mm_mullo_epi16(_mm_unpackhi_epi8(code, zero), place));
+
+        code = LOOKUP_SSE(t->col_code[x], v, high);
+        place = _mm_set1_epi16((short)t->place[y]);
+        col_lo[x] = _mm_add_epi16(col_lo[x], _mm_mullo_epi16(_mm_unpacklo_epi8(code, zero), place));
+        col_hi[x] = _mm_add_epi16(col_hi[x], _mm_mullo_epi16(_mm_unpackhi_epi8(code, zero), place));
+    }
+#undef LOOKUP_SSE
+
+    for (int line = 0; line < t->size; line++) {
+        const __m128i *halves[4] = {&row_lo[line], &row_hi[line], &col_lo[line], &col_hi[line]};
+        for (int h = 0; h < 4; h++) {
+            _mm_storeu_si128((__m128i *)keys, *halves[h]);
+            for (int i = 0; i < 8; i++) {
+                conflicts[(h & 1) * 8 + i] += t->conflicts[keys[i]];
+            }
+        }
+    }
+
+    _mm_storeu_si128((__m128i *)md_out, manhattan);
+    _mm_storeu_si128((__m128i *)mis_out, misplaced);
+    for (int lane = 0; lane < lanes; lane++) {
+        finish_score(&scores[lane], md_out[lane], conflicts[lane], mis_out[lane]);
+    }
+}
+
+// 32 boards: as above on 256-bit vectors (shuffles stay within each 128-bit
+// half, so tables are broadcast to both), and the conflicts come from
+// 8-wide gathers. Widening to 16 bits also works per half: the low words
+// hold boards 0-7 and 16-23, the high words 8-15 and 24-31.
+__attribute__((target("avx2")))
+static void score_avx2(const ScoreTables *t, const uint8_t tiles[PACKED_MAX_CELLS][BLOCK_LANES],
+                       int lanes, StateScore *scores) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i fifteen = _mm256_set1_epi8(15);
+    const __m256i one = _mm256_set1_epi8(1);
+    __m256i manhattan = zero, misplaced = zero;
+    __m256i row_lo[PACKED_MAX_SIZE], row_hi[PACKED_MAX_SIZE];
+    __m256i col_lo[PACKED_MAX_SIZE], col_hi[PACKED_MAX_SIZE];
+    __m256i conflicts[4];  // Boards 0-7, 8-15, 16-23, 24-31
+    uint8_t md_out[32], mis_out[32];
+    int32_t lc_out[32];
+
+    for (int line = 0; line < t->size; line++) {
+        row_lo[line] = row_hi[line] = col_lo[line] = col_hi[line] = zero;
+    }
+
+    int wide = t->cells > 16;
+#define LOOKUP_AVX2(table, v, high) \
+    (wide ? _mm256_blendv_epi8( \
+                _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(table))), v), \
+                _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)((table) + 16))), v), \
+                high) \
+          : _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(table))), v))
+
+    for (int cell = 0; cell < t->cells; cell++) {
+        int x = cell % t->size;
+        int y = cell / t->size;
+        __m256i v = _mm256_loadu_si256((const __m256i *)tiles[cell]);
+        __m256i high = _mm256_cmpgt_epi8(v, fifteen);
+
+        manhattan = _mm256_add_epi8(manhattan, LOOKUP_AVX2(t->md[cell], v, high));
+        __m256i home = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)(cell + 1))),
+                                       _mm256_cmpeq_epi8(v, zero));
+        misplaced = _mm256_add_epi8(misplaced, _mm256_andnot_si256(home, one));
+
+        __m256i code = LOOKUP_AVX2(t->row_code[y], v, high);
+        __m256i place = _mm256_set1_epi16((short)t->place[x]);
+        row_lo[y] = _mm256_add_epi16(row_lo[y], _mm256_mullo_epi16(_mm256_unpacklo_epi8(code, zero), place));
+        row_hi[y] = _mm256_add_epi16(row_hi[y], _mm256_mullo_epi16(_mm256_unpackhi_epi8(code, zero), place));
+
+        code = LOOKUP_AVX2(t->col_code[x], v, high);
+        place = _mm256_set1_epi16((short)t->place[y]);
+        col_lo[x] = _mm256_add_epi16(col_lo[x], _mm256_mullo_epi16(_mm256_unpacklo_epi8(code, zero), place));
+        col_hi[x] = _mm256_add_epi16(col_hi[x], _mm256_mullo_epi16(_mm256_unpackhi_epi8(code, zero), place));
+    }
+#undef LOOKUP_AVX2
+
+    for (int i = 0; i < 4; i++) {
+        conflicts[i] = zero;
+    }
+    for (int line = 0; line < t->size; line++) {
+        const __m256i *halves[4] = {&row_lo[line], &row_hi[line], &col_lo[line], &col_hi[line]};
+        for (int h = 0; h < 4; h++) {
+            // Low words: boards 0-7 then 16-23; high words: 8-15 then 24-31
+            __m256i first = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(*halves[h]));
+            __m256i second = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(*halves[h], 1));
+            int base = h & 1;
+            conflicts[base] = _mm256_add_epi32(conflicts[base],
+                                               _mm256_i32gather_epi32(t->conflicts, first, 4));
+            conflicts[base + 2] = _mm256_add_epi32(conflicts[base + 2],
+                                                   _mm256_i32gather_epi32(t->conflicts, second, 4));
+        }
+    }
+
+    _mm256_storeu_si256((__m256i *)md_out, manhattan);
+    _mm256_storeu_si256((__m256i *)mis_out, misplaced);
+    for (int i = 0; i < 4; i++) {
+        _mm256_storeu_si256((__m256i *)(lc_out + 8 * i), conflicts[i]);
+    }
+    for (int lane = 0; lane < lanes; lane++) {
+        finish_score(&scores[lane], md_out[lane], lc_out[lane], mis_out[lane]);
+    }
+}
+
+#endif // HEURISTIC_X86
+
+int heuristic_isa_supported(HeuristicIsa isa) {
+    switch (isa) {
+        case HEURISTIC_SCALAR:
+            return 1;
+#ifdef HEURISTIC_X86
+        case HEURISTIC_SSE41:
+            return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1");
+        case HEURISTIC_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return 0;
+    }
+}
+
+HeuristicIsa heuristic_best_isa(void) {
+    static int best = -1;
+    int isa = __atomic_load_n(&best, __ATOMIC_RELAXED);
+
+    if (isa < 0) {
+        isa = HEURISTIC_ISA_COUNT - 1;
+        while (isa > HEURISTIC_SCALAR && !heuristic_isa_supported((HeuristicIsa)isa)) {
+            isa--;
+        }
+        __atomic_store_n(&best, isa, __ATOMIC_RELAXED);
+    }
+    return (HeuristicIsa)isa;
+}
+
+const char *heuristic_isa_name(HeuristicIsa isa) {
+    static const char *names[HEURISTIC_ISA_COUNT] = {"scalar", "sse4.1", "avx2"};
+    return isa < HEURISTIC_ISA_COUNT ? names[isa] : "unknown";
+}
+
+int heuristic_score(const PackedBoard *boards, size_t count, StateScore *scores) {
+    return heuristic_score_with(heuristic_best_isa(), boards, count, scores);
+}
+
+int heuristic_score_with(HeuristicIsa isa, const PackedBoard *boards, size_t count,
+                         StateScore *scores) {
+    typedef void (*Kernel)(const ScoreTables *, const uint8_t[PACKED_MAX_CELLS][BLOCK_LANES],
+                           int, StateScore *);
+    uint8_t tiles[PACKED_MAX_CELLS][BLOCK_LANES];
+    Kernel kernel = score_scalar;
+    int width = BLOCK_LANES;
+
+    if (!heuristic_isa_supported(isa)) {
+        return 0;
+    }
+#ifdef HEURISTIC_X86
+    if (isa == HEURISTIC_SSE41) {
+        kernel = score_sse41;
+        width = 16;
+    } else if (isa == HEURISTIC_AVX2) {
+        kernel = score_avx2;
+    }
+#endif
+    pthread_once(&tables_once, build_tables);
+
+    // Blocks never mix sizes: each one ends where the size changes
+    for (size_t i = 0; i < count;) {
+        int size = boards[i].size;
+        size_t lanes = 1;
+        while (lanes < (size_t)width && i + lanes < count && boards[i + lanes].size == size) {
+            lanes++;
+        }
+        if (size < 3 || size > PACKED_MAX_SIZE) {
+            return 0;
+        }
+        unpack_block(boards + i, lanes, width, tiles);
+        kernel(&score_tables[size], (const uint8_t (*)[BLOCK_LANES])tiles, (int)lanes, scores + i);
+        i += lanes;
+    }
+    return 1;
+}
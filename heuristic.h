@@ -0,0 +1,48 @@
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bitboard.h"
+
+// Batch scoring of packed boards: Manhattan distance, linear conflicts and
+// misplaced tiles for many boards at once. Boards are laid out one per byte
+// lane (16 per SSE4.1 block, 32 per AVX2 block) and every cell is scored
+// across the whole block with table lookups, so the per-board cost is a few
+// instructions per cell. The best kernel this CPU supports is picked at run
+// time; every kernel gives the same scores as the scalar one.
+
+typedef struct {
+    uint16_t manhattan;
+    uint16_t conflicts;  // Linear-conflict penalty, as in solver_heuristic
+    uint16_t misplaced;  // Tiles off their goal cell (the empty cell never counts)
+    uint16_t total;      // manhattan + conflicts: solver_heuristic's value
+} StateScore;
+
+// Linear conflicts of one row or column, shared with the solver so both
+// score boards alike. A line key is a base-(size + 1) number, one digit per
+// cell of the line (first cell lowest) holding the tile's goal offset along
+// the line, or size if the tile belongs to another line; the penalty is
+// twice the tiles outside the longest in-order run of the line's own tiles.
+#define HEURISTIC_LINE_KEYS 7776  // (PACKED_MAX_SIZE + 1) ^ PACKED_MAX_SIZE
+
+int heuristic_line_penalty(int size, int key);
+
+typedef enum {
+    HEURISTIC_SCALAR,
+    HEURISTIC_SSE41,
+    HEURISTIC_AVX2,
+    HEURISTIC_ISA_COUNT
+} HeuristicIsa;
+
+int heuristic_isa_supported(HeuristicIsa isa);
+HeuristicIsa heuristic_best_isa(void);
+const char *heuristic_isa_name(HeuristicIsa isa);
+
+// Score boards of any mix of sizes with the best kernel, or a given one;
+// returns 0 if the kernel is not supported here
+int heuristic_score(const PackedBoard *boards, size_t count, StateScore *scores);
+int heuristic_score_with(HeuristicIsa isa, const PackedBoard *boards, size_t count,
+                         StateScore *scores);
+
+#endif // HEURISTIC_H
@@ -0,0 +1,284 @@
+/**
+ * Taquin - Move Log Tool
+ *
+ * Streams the game's move log (data/games.log) one block at a time, so logs
+ * of any size are checked without loading them (no SDL required):
+ *   taquin-log verify <file> [--solve] [-p pdb-file]  replay every game
+ *   taquin-log dump <file> [first [count]]            games as JSON lines
+ *   taquin-log gen <file> [-n count] [-s size] [--seed N]
+ *                                                     append synthetic games
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "board.h"
+#include "boardgen.h"
+#include "movelog.h"
+#include "pdb.h"
+#include "solver.h"
+
+static const char move_letters[MOVE_COUNT] = {'L', 'R', 'U', 'D'};
+
+static int usage(void) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  taquin-log verify <file> [--solve] [-p pdb-file]\n");
+    fprintf(stderr, "      replays every game; --solve also compares each solved game\n");
+    fprintf(stderr, "      with an optimal solution (5x5 and smaller)\n");
+    fprintf(stderr, "  taquin-log dump <file> [first [count]]\n");
+    fprintf(stderr, "  taquin-log gen <file> [-n count] [-s size] [--seed N]\n");
+    return EXIT_FAILURE;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int verify(const char *path, int solve, const char *pdb_path) {
+    MoveLogIndex index;
+    MoveLogReader reader;
+    MoveLogGame game = {0};
+    Board board = {0};
+    PdbSet pdb;
+    SolverConfig config = {0};
+    uint64_t games = 0, moves = 0, solved = 0, illegal = 0, mismatched = 0;
+    uint64_t compared = 0, optimal = 0, excess = 0, unsolved = 0;
+
+    if (pdb_path) {
+        if (!pdb_open(&pdb, pdb_path)) {
+            fprintf(stderr, "Cannot open pattern database %s\n", pdb_path);
+            return EXIT_FAILURE;
+        }
+        config.pdb = &pdb;
+    }
+    if (!movelog_index(&index, path) || !movelog_reader_open(&reader, path)) {
+        fprintf(stderr, "%s is not a move log\n", path);
+        movelog_index_free(&index);
+        return EXIT_FAILURE;
+    }
+
+    double start = now_seconds();
+    while (movelog_reader_next(&reader, &game)) {
+        games++;
+        moves += game.move_count;
+        if (!movelog_game_replay(&game, &board)) {
+            fprintf(stderr, "Game %llu: a move leaves the board\n",
+                    (unsigned long long)(reader.next_game - 1));
+            illegal++;
+            continue;
+        }
+        if (board_is_solved(&board) != ((game.flags & MOVELOG_SOLVED) != 0)) {
+            fprintf(stderr, "Game %llu: final board and solved flag disagree\n",
+                    (unsigned long long)(reader.next_game - 1));
+            mismatched++;
+        }
+        if (!board_is_solved(&board)) {
+            continue;
+        }
+        solved++;
+
+        // Regression check: no solver solution may be longer than a game.
+        // Boards too large for IDA* without pattern databases are left out
+        PackedBoard packed;
+        SolverResult result;
+        if (solve && game.start.size >= SOLVER_PDB_MIN_SIZE &&
+            (!config.pdb || config.pdb->size != game.start.size)) {
+            unsolved++;
+            continue;
+        }
+        if (solve && board_to_packed(&game.start, &packed) &&
+            solver_solve_with(&packed, &config, &result) && result.status == SOLVER_SOLVED) {
+            compared++;
+            if ((size_t)result.length > game.move_count) {
+                fprintf(stderr, "Game %llu: solver needs %d moves, the game took %zu\n",
+                        (unsigned long long)(reader.next_game - 1), result.length,
+                        game.move_count);
+                mismatched++;
+            } else {
+                optimal += (size_t)result.length == game.move_count;
+                excess += game.move_count - (size_t)result.length;
+            }
+        }
+    }
+    double elapsed = now_seconds() - start;
+    long bytes = ftell(reader.file);
+
+    printf("%llu games (%llu solved), %llu moves, %ld bytes: %.2f bits per move\n",
+           (unsigned long long)games, (unsigned long long)solved, (unsigned long long)moves,
+           bytes, moves ? (double)bytes * 8.0 / (double)moves : 0.0);
+    printf("%.3f s, %.2f Mmoves/s\n", elapsed, elapsed > 0 ? (double)moves / elapsed / 1e6 : 0.0);
+    if (compared) {
+        printf("%llu compared with the solver: %llu optimal, %.1f extra moves on average\n",
+               (unsigned long long)compared, (unsigned long long)optimal,
+               (double)excess / (double)compared);
+    }
+    if (unsolved) {
+        printf("%llu games not compared: %dx%d and larger need a pattern database (-p)\n",
+               (unsigned long long)unsolved, SOLVER_PDB_MIN_SIZE, SOLVER_PDB_MIN_SIZE);
+    }
+    if (reader.damaged) {
+        printf("%llu damaged blocks skipped\n", (unsigned long long)reader.damaged);
+    }
+    // The headers alone account for every game; anything unread is lost
+    uint64_t missing = index.games > games ? index.games - games : 0;
+    if (missing || index.damaged) {
+        printf("%llu of %llu indexed games unread%s\n", (unsigned long long)missing,
+               (unsigned long long)index.games,
+               index.damaged ? ", and a damaged block header hides the rest" : "");
+    }
+
+    int ok = illegal == 0 && mismatched == 0 && reader.damaged == 0 && missing == 0 &&
+             !index.damaged;
+    movelog_index_free(&index);
+    printf("%s\n", ok ? "OK" : "FAILED");
+    movelog_reader_close(&reader);
+    movelog_game_free(&game);
+    board_free(&board);
+    if (config.pdb) {
+        pdb_close(&pdb);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int dump(const char *path, uint64_t first, uint64_t count) {
+    MoveLogIndex index;
+    MoveLogReader reader;
+    MoveLogGame game = {0};
+
+    if (!movelog_index(&index, path) || !movelog_reader_open(&reader, path)) {
+        fprintf(stderr, "%s is not a move log\n", path);
+        return EXIT_FAILURE;
+    }
+    if (first > 0 && !movelog_reader_seek(&reader, &index, first)) {
+        if (reader.damaged) {
+            fprintf(stderr, "Game %llu is in a damaged block of %s\n", (unsigned long long)first,
+                    path);
+        } else {
+            fprintf(stderr, "%s has %llu games\n", path, (unsigned long long)index.games);
+        }
+        movelog_reader_close(&reader);
+        movelog_index_free(&index);
+        return EXIT_FAILURE;
+    }
+
+    for (uint64_t n = 0; n < count && movelog_reader_next(&reader, &game); n++) {
+        printf("{\"game\":%llu,\"size\":%d,\"seed\":%llu,\"ms\":%u,\"solved\":%s,\"board\":\"",
+               (unsigned long long)(reader.next_game - 1), game.start.size,
+               (unsigned long long)game.seed, game.duration_ms,
+               game.flags & MOVELOG_SOLVED ? "true" : "false");
+        for (int cell = 0; cell < game.start.cells; cell++) {
+            printf(cell ? " %d" : "%d", game.start.tiles[cell]);
+        }
+        printf("\",\"length\":%zu,\"moves\":\"", game.move_count);
+        for (size_t i = 0; i < game.move_count; i++) {
+            putchar(move_letters[game.moves[i]]);
+        }
+        printf("\"}\n");
+    }
+
+    movelog_reader_close(&reader);
+    movelog_index_free(&index);
+    movelog_game_free(&game);
+    return EXIT_SUCCESS;
+}
+
+// Synthetic games: a random walk away from the goal is the start board and
+// the walk back is the game, so every game ends solved
+static int generate(const char *path, long count, int size, uint64_t seed) {
+    MoveLogWriter writer;
+    MoveLogGame game = {0};
+    Board board = {0};
+    uint8_t *walk = NULL;
+    Rng rng;
+    int ok = 1;
+
+    if (!movelog_writer_open(&writer, path)) {
+        fprintf(stderr, "Cannot append to %s\n", path);
+        return EXIT_FAILURE;
+    }
+    rng_seed(&rng, seed);
+    fprintf(stderr, "# seed %llu\n", (unsigned long long)seed);
+
+    size_t longest = (size_t)size * (size_t)size * 16;
+    walk = malloc(longest);
+    for (long n = 0; ok && walk && n < count; n++) {
+        size_t length = 1 + rng_below(&rng, (uint32_t)longest);
+
+        board_init(&board, size);
+        for (size_t i = 0; i < length; i++) {
+            int dir, cell;
+            do {
+                dir = (int)rng_below(&rng, MOVE_COUNT);
+                cell = board_neighbor(&board, dir);
+            } while (cell < 0);
+            board_slide(&board, cell);
+            walk[i] = (uint8_t)dir;
+        }
+
+        ok = movelog_game_begin(&game, &board, 0);
+        for (size_t i = length; ok && i-- > 0;) {
+            ok = movelog_game_add(&game, walk[i] ^ 1);  // Opposite direction
+        }
+        game.flags = MOVELOG_SOLVED;
+        game.duration_ms = (uint32_t)(length * 250);
+        ok = ok && movelog_writer_append(&writer, &game);
+    }
+    ok = walk && ok;
+    ok = movelog_writer_close(&writer) && ok;
+
+    free(walk);
+    movelog_game_free(&game);
+    board_free(&board);
+    if (!ok) {
+        fprintf(stderr, "Failed to write %s\n", path);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "verify") == 0) {
+        int solve = 0;
+        const char *pdb_path = NULL;
+        for (int i = 3; i < argc; i++) {
+            if (strcmp(argv[i], "--solve") == 0) {
+                solve = 1;
+            } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+                pdb_path = argv[++i];
+            } else {
+                return usage();
+            }
+        }
+        return verify(argv[2], solve, pdb_path);
+    }
+    if (argc >= 3 && argc <= 5 && strcmp(argv[1], "dump") == 0) {
+        uint64_t first = argc > 3 ? strtoull(argv[3], NULL, 10) : 0;
+        uint64_t count = argc > 4 ? strtoull(argv[4], NULL, 10) : UINT64_MAX;
+        return dump(argv[2], first, count);
+    }
+    if (argc >= 3 && strcmp(argv[1], "gen") == 0) {
+        long count = 1000;
+        int size = 4;
+        uint64_t seed = (uint64_t)time(NULL);
+        for (int i = 3; i < argc; i++) {
+            if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+                count = atol(argv[++i]);
+            } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+                size = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+                seed = strtoull(argv[++i], NULL, 10);
+            } else {
+                return usage();
+            }
+        }
+        if (size < BOARD_MIN_SIZE || size > BOARD_MAX_SIZE || count < 0) {
+            return usage();
+        }
+        return generate(argv[2], count, size, seed);
+    }
+    return usage();
+}
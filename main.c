@@ -11,78 +11,178 @@
 
 #include "functions.h"
 
+#if TAQUIN_PROFILE
+// Ticks when the oldest input not yet shown on screen was handled, 0 if none
+static uint64_t input_start;
+#endif
+
+// Dispatch one event by game state; returns 0 when the game should quit
+static int handle_event(SDL_Event *event) {
+    if (event->type == SDL_QUIT) {
+        return 0;
+    }
+
+#if TAQUIN_PROFILE
+    if ((event->type == SDL_KEYDOWN || event->type == SDL_MOUSEBUTTONDOWN) && !input_start) {
+        input_start = profile_ticks();
+    }
+    // F3 on any screen: frame-time overlay
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_F3) {
+        game.show_profile = !game.show_profile;
+        invalidate_render();
+        return 1;
+    }
+#endif
+
+    // The window contents or the board texture may be gone: redraw fully
+    if (event->type == SDL_WINDOWEVENT) {
+        invalidate_render();
+    } else if (event->type == SDL_RENDER_TARGETS_RESET) {
+        free_render_cache();
+    } else if (event->type == SDL_RENDER_DEVICE_RESET) {
+        free_render_cache();
+        free_textures();
+        load_textures();
+    }
+
+    switch (game.state) {
+        case GAME_STATE_MENU:
+            handle_menu_input(event);
+            break;
+
+        case GAME_STATE_PLAYING:
+            handle_game_input(event);
+            break;
+
+        case GAME_STATE_WIN:
+            if (event->type == SDL_KEYDOWN) {
+                if (event->key.keysym.sym == SDLK_SPACE ||
+                    event->key.keysym.sym == SDLK_RETURN) {
+                    game.state = GAME_STATE_MENU;
+                } else if (event->key.keysym.sym == SDLK_r) {
+                    reset_game(game.board_size);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+    return 1;
+}
+
 int main(int argc, char *argv[]) {
+    // Optional fixed seed for reproducible shuffles: --seed N
+    // Optional board to start on, skipping the menu: --size N (3 to 32)
+    // Optional logged game to play back: --replay N (-1 for the latest)
+    int start_size = 0;
+    const char *replay = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            game.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            start_size = atoi(argv[++i]);
+            if (start_size < MIN_BOARD_SIZE || start_size > MAX_BOARD_SIZE) {
+                fprintf(stderr, "Board size must be %d to %d\n", MIN_BOARD_SIZE, MAX_BOARD_SIZE);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay = argv[++i];
+        }
+    }
+
     // Initialize the game
     if (!init_game()) {
         fprintf(stderr, "Failed to initialize game\n");
         return EXIT_FAILURE;
     }
+#if TAQUIN_PROFILE
+    profile_init();
+#endif
 
     printf("=== Taquin - Sliding Puzzle Game ===\n");
     printf("Controls:\n");
-    printf("  Menu: Press 3, 4, or 5 to select grid size\n");
+    printf("  Menu: Press 3 to 9 to select grid size (--size N up to %d)\n", MAX_BOARD_SIZE);
     printf("  Game: Click tiles to move them\n");
     printf("  ESC: Return to menu\n");
     printf("  R: Reset current game\n");
     printf("  N: New shuffle\n");
+    printf("  H: Hint (outlines the next tile to move)\n");
+    printf("  A: Auto-solve (press again to stop)\n");
+    printf("  D: Show or hide the distance readout\n");
+    printf("  P: Replay the last game (menu, or --replay N)\n");
+#if TAQUIN_PROFILE
+    printf("  F3: Frame-time overlay\n");
+#endif
     printf("  Q: Quit game\n\n");
 
-    // Main game loop
+    if (start_size) {
+        reset_game(start_size);
+    }
+    if (replay) {
+        start_replay(strcmp(replay, "-1") == 0 ? UINT64_MAX : strtoull(replay, NULL, 10));
+    }
+
+    // Main game loop: fixed-timestep simulation, frames paced by vsync or
+    // by sleeping to TARGET_FPS, and blocking on events while idle
     SDL_bool running = SDL_TRUE;
-    Uint32 last_time = SDL_GetTicks();
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 step = frequency / SIMULATION_HZ;
+    Uint64 frame_ticks = frequency / TARGET_FPS;
+    Uint64 previous = SDL_GetPerformanceCounter();
+    Uint64 accumulator = 0;
+
+    // With vsync the display paces frames at its own rate (144 Hz included)
+    SDL_RendererInfo info;
+    SDL_bool vsync = SDL_GetRendererInfo(game.renderer, &info) == 0 &&
+                     (info.flags & SDL_RENDERER_PRESENTVSYNC);
 
     while (running) {
-        Uint32 current_time = SDL_GetTicks();
-        Uint32 delta_time = current_time - last_time;
-        last_time = current_time;
+        Uint64 frame_start = SDL_GetPerformanceCounter();
+        Uint64 elapsed = frame_start - previous;
+        previous = frame_start;
+        PROFILE_BEGIN(PROFILE_FRAME);
 
         // Handle events
         SDL_Event event;
+        PROFILE_BEGIN(PROFILE_EVENTS);
         while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                running = SDL_FALSE;
-            } else {
-                // Handle input based on current game state
-                switch (game.state) {
-                    case GAME_STATE_MENU:
-                        handle_menu_input(&event);
-                        break;
-
-                    case GAME_STATE_PLAYING:
-                        handle_game_input(&event);
-                        break;
-
-                    case GAME_STATE_WIN:
-                        if (event.type == SDL_KEYDOWN) {
-                            if (event.key.keysym.sym == SDLK_SPACE ||
-                                event.key.keysym.sym == SDLK_RETURN) {
-                                game.state = GAME_STATE_MENU;
-                            } else if (event.key.keysym.sym == SDLK_r) {
-                                reset_game(game.board_size);
-                            }
-                        }
-                        break;
-
-                    default:
-                        break;
-                }
-            }
+            running = handle_event(&event) && running;
         }
+        PROFILE_END(PROFILE_EVENTS);
 
-        // Update game logic
+        // Play time keeps its remainder, so the timer never drifts
         if (game.state == GAME_STATE_PLAYING) {
-            update_animations();
+            game.stats.play_ticks += elapsed;
+            game.stats.time_seconds = (int)(game.stats.play_ticks / frequency);
+        }
 
-            // Update timer (every second)
-            static Uint32 timer_accumulator = 0;
-            timer_accumulator += delta_time;
-            if (timer_accumulator >= 1000) {
-                game.stats.time_seconds++;
-                timer_accumulator = 0;
+        // Advance the simulation in fixed steps; after a long stall only
+        // the last few steps are replayed
+        PROFILE_BEGIN(PROFILE_UPDATE);
+        accumulator += elapsed;
+        if (accumulator > step * MAX_CATCHUP_STEPS) {
+            accumulator = step * MAX_CATCHUP_STEPS;
+        }
+        while (accumulator >= step) {
+            if (game.state == GAME_STATE_PLAYING) {
+                update_solver();
+                update_replay();
             }
+            accumulator -= step;
         }
 
+        // Slides follow real time, not steps, so they advance every frame
+        if (game.state == GAME_STATE_PLAYING) {
+            update_animations();
+        }
+
+        // Upload images decoded since the last frame
+        poll_textures();
+        PROFILE_END(PROFILE_UPDATE);
+
         // Render based on current state
+        PROFILE_BEGIN(PROFILE_RENDER);
         switch (game.state) {
             case GAME_STATE_MENU:
                 render_menu();
@@ -100,12 +200,35 @@ int main(int argc, char *argv[]) {
                 render_menu();
                 break;
         }
+        PROFILE_END(PROFILE_RENDER);
+        PROFILE_END(PROFILE_FRAME);
+#if TAQUIN_PROFILE
+        if (input_start) {
+            profile_record(PROFILE_INPUT, profile_ticks() - input_start);
+            input_start = 0;
+        }
+#endif
 
-        // Cap frame rate to ~60 FPS
-        SDL_Delay(16);
+        // Nothing moving: sleep until input arrives instead of redrawing
+        if (!game.is_animating && !game.solving && !game.autoplay && !game.replaying &&
+            !game.atlas.pending) {
+            if (SDL_WaitEventTimeout(&event, IDLE_WAIT_MS)) {
+                running = handle_event(&event) && running;
+            }
+            continue;
+        }
+
+        // Present returns early without vsync; sleep off the rest of the frame
+        Uint64 spent = SDL_GetPerformanceCounter() - frame_start;
+        if (!vsync && spent < frame_ticks) {
+            SDL_Delay((Uint32)((frame_ticks - spent) * 1000 / frequency));
+        }
     }
 
     // Cleanup and exit
+#if TAQUIN_PROFILE
+    profile_report(stdout);
+#endif
     cleanup_game();
     printf("Thanks for playing Taquin!\n");
 
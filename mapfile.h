@@ -0,0 +1,16 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stddef.h>
+
+// Read-only memory mapping of a whole file
+typedef struct {
+    void *data;
+    size_t size;
+    void *handle;  // Mapping object on Windows
+} MappedFile;
+
+int map_file(MappedFile *file, const char *path);
+void unmap_file(MappedFile *file);
+
+#endif // MAPFILE_H
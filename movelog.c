@@ -0,0 +1,523 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "movelog.h"
+#include "pdb.h"
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+static const char movelog_magic[8] = {'T', 'Q', 'M', 'O', 'V', 'E', 'S', 0};
+static const char block_magic[4] = {'T', 'Q', 'B', 'K'};
+
+// Game encoding, byte-aligned per game:
+//   move count (varint), size, flags, seed (8 bytes), duration in ms (varint),
+//   tiles row-major in the fewest bits that hold size * size - 1,
+//   moves four to a byte, lowest bits first
+
+// Bits per tile for a board of this many cells
+static int field_width(int cells) {
+    int bits = 1;
+    while ((1 << bits) < cells) {
+        bits++;
+    }
+    return bits;
+}
+
+static size_t put_varint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static int get_varint(const uint8_t *data, size_t bytes, size_t *pos, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && *pos < bytes; shift += 7) {
+        uint8_t byte = data[(*pos)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Largest encoding a game can take
+static size_t encoded_bound(const MoveLogGame *game) {
+    size_t tile_bits = (size_t)game->start.cells * (size_t)field_width(game->start.cells);
+    return 10 + 2 + 8 + 5 + (tile_bits + 7) / 8 + (game->move_count + 3) / 4;
+}
+
+static size_t encode_game(const MoveLogGame *game, uint8_t *out) {
+    const Board *start = &game->start;
+    int bits = field_width(start->cells);
+    size_t n = put_varint(out, game->move_count);
+
+    out[n++] = (uint8_t)start->size;
+    out[n++] = (uint8_t)game->flags;
+    for (int i = 0; i < 8; i++) {
+        out[n++] = (uint8_t)(game->seed >> (8 * i));
+    }
+    n += put_varint(out + n, game->duration_ms);
+
+    uint64_t pending = 0;
+    int filled = 0;
+    for (int cell = 0; cell < start->cells; cell++) {
+        pending |= (uint64_t)start->tiles[cell] << filled;
+        for (filled += bits; filled >= 8; filled -= 8) {
+            out[n++] = (uint8_t)pending;
+            pending >>= 8;
+        }
+    }
+    if (filled > 0) {
+        out[n++] = (uint8_t)pending;
+    }
+
+    size_t move_bytes = (game->move_count + 3) / 4;
+    memset(out + n, 0, move_bytes);
+    for (size_t i = 0; i < game->move_count; i++) {
+        out[n + i / 4] |= (uint8_t)((game->moves[i] & 3) << (2 * (i % 4)));
+    }
+    return n + move_bytes;
+}
+
+static int reserve_moves(MoveLogGame *game, size_t count) {
+    if (count <= game->move_capacity) {
+        return 1;
+    }
+    size_t capacity = game->move_capacity ? game->move_capacity : 256;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    uint8_t *moves = realloc(game->moves, capacity);
+    if (!moves) {
+        return 0;
+    }
+    game->moves = moves;
+    game->move_capacity = capacity;
+    return 1;
+}
+
+// Decode the game at *pos, or only step over it when game is NULL
+static int decode_game(const uint8_t *data, size_t bytes, size_t *pos, MoveLogGame *game) {
+    uint64_t move_count, duration;
+    size_t p = *pos;
+
+    if (!get_varint(data, bytes, &p, &move_count) || bytes - p < 10) {
+        return 0;
+    }
+    int size = data[p];
+    uint32_t flags = data[p + 1];
+    uint64_t seed = 0;
+    for (int i = 0; i < 8; i++) {
+        seed |= (uint64_t)data[p + 2 + i] << (8 * i);
+    }
+    p += 10;
+    if (!get_varint(data, bytes, &p, &duration) ||
+        size < BOARD_MIN_SIZE || size > BOARD_MAX_SIZE) {
+        return 0;
+    }
+
+    int cells = size * size;
+    int bits = field_width(cells);
+    size_t tile_bytes = ((size_t)cells * (size_t)bits + 7) / 8;
+    if (bytes - p < tile_bytes || move_count > (uint64_t)(bytes - p - tile_bytes) * 4) {
+        return 0;
+    }
+    size_t move_bytes = (size_t)(move_count + 3) / 4;
+
+    if (game) {
+        uint8_t seen[BOARD_MAX_CELLS] = {0};
+        uint64_t pending = 0;
+        int filled = 0;
+        size_t in = p;
+
+        if (!board_init(&game->start, size) || !reserve_moves(game, (size_t)move_count)) {
+            return 0;
+        }
+        for (int cell = 0; cell < cells; cell++) {
+            while (filled < bits) {
+                pending |= (uint64_t)data[in++] << filled;
+                filled += 8;
+            }
+            int tile = (int)(pending & ((1u << bits) - 1));
+            pending >>= bits;
+            filled -= bits;
+            if (tile >= cells || seen[tile]) {
+                return 0;
+            }
+            seen[tile] = 1;
+            game->start.tiles[cell] = (uint16_t)tile;
+            if (tile == 0) {
+                game->start.empty = cell;
+            }
+        }
+        board_recount(&game->start);
+
+        const uint8_t *packed = data + p + tile_bytes;
+        for (size_t i = 0; i < move_count; i++) {
+            game->moves[i] = (uint8_t)((packed[i / 4] >> (2 * (i % 4))) & 3);
+        }
+        game->move_count = (size_t)move_count;
+        game->seed = seed;
+        game->duration_ms = (uint32_t)duration;
+        game->flags = flags;
+    }
+    *pos = p + tile_bytes + move_bytes;
+    return 1;
+}
+
+// Games
+
+int movelog_game_begin(MoveLogGame *game, const Board *start, uint64_t seed) {
+    if (!board_copy(&game->start, start)) {
+        return 0;
+    }
+    game->seed = seed;
+    game->move_count = 0;
+    game->duration_ms = 0;
+    game->flags = 0;
+    return 1;
+}
+
+int movelog_game_add(MoveLogGame *game, int dir) {
+    if (!reserve_moves(game, game->move_count + 1)) {
+        return 0;
+    }
+    game->moves[game->move_count++] = (uint8_t)dir;
+    return 1;
+}
+
+void movelog_game_free(MoveLogGame *game) {
+    board_free(&game->start);
+    free(game->moves);
+    memset(game, 0, sizeof(*game));
+}
+
+int movelog_game_replay(const MoveLogGame *game, Board *board) {
+    if (!board_copy(board, &game->start)) {
+        return 0;
+    }
+    for (size_t i = 0; i < game->move_count; i++) {
+        int cell = board_neighbor(board, game->moves[i]);
+        if (cell < 0) {
+            return 0;
+        }
+        board_slide(board, cell);
+    }
+    return 1;
+}
+
+// Index
+
+static int valid_block_header(const MoveLogBlockHeader *header) {
+    return memcmp(header->magic, block_magic, sizeof(block_magic)) == 0 &&
+           header->bytes <= MOVELOG_MAX_BLOCK_BYTES;
+}
+
+static uint64_t block_checksum(const MoveLogBlockHeader *header, const uint8_t *payload) {
+    uint64_t checksum = pdb_checksum(header, offsetof(MoveLogBlockHeader, checksum), 0);
+    return pdb_checksum(payload, header->bytes, checksum);
+}
+
+// Open a log and check its file header
+static FILE *open_log(const char *path) {
+    MoveLogFileHeader header;
+    FILE *file = fopen(path, "rb");
+
+    if (file && (fread(&header, sizeof(header), 1, file) != 1 ||
+                 memcmp(header.magic, movelog_magic, sizeof(movelog_magic)) != 0 ||
+                 header.version != MOVELOG_VERSION)) {
+        fclose(file);
+        file = NULL;
+    }
+    return file;
+}
+
+int movelog_index(MoveLogIndex *index, const char *path) {
+    size_t capacity = 0;
+    long size;
+
+    memset(index, 0, sizeof(*index));
+    FILE *file = open_log(path);
+    if (!file || fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0) {
+        if (file) {
+            fclose(file);
+        }
+        return 0;
+    }
+
+    long offset = (long)sizeof(MoveLogFileHeader);
+    index->end = offset;
+    while (size - offset >= (long)sizeof(MoveLogBlockHeader)) {
+        MoveLogBlockHeader header;
+        // A sound header whose payload runs past the end is a torn append;
+        // a header that cannot be read or makes no sense is damage
+        if (fseek(file, offset, SEEK_SET) != 0 ||
+            fread(&header, sizeof(header), 1, file) != 1 || !valid_block_header(&header)) {
+            index->damaged = 1;
+            break;
+        }
+        if ((long)header.bytes > size - offset - (long)sizeof(header)) {
+            break;
+        }
+
+        if (index->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            MoveLogBlock *blocks = realloc(index->blocks, capacity * sizeof(MoveLogBlock));
+            if (!blocks) {
+                fclose(file);
+                movelog_index_free(index);
+                return 0;
+            }
+            index->blocks = blocks;
+        }
+        index->blocks[index->count++] = (MoveLogBlock){offset, index->games, header.games};
+        index->games += header.games;
+        offset += (long)sizeof(header) + (long)header.bytes;
+        index->end = offset;
+    }
+    fclose(file);
+    return 1;
+}
+
+void movelog_index_free(MoveLogIndex *index) {
+    free(index->blocks);
+    memset(index, 0, sizeof(*index));
+}
+
+// Writer
+
+static int truncate_log(const char *path, long length) {
+#ifdef _WIN32
+    FILE *file = fopen(path, "r+b");
+    int ok = file && _chsize(_fileno(file), length) == 0;
+    if (file) {
+        fclose(file);
+    }
+    return ok;
+#else
+    return truncate(path, (off_t)length) == 0;
+#endif
+}
+
+int movelog_writer_open(MoveLogWriter *writer, const char *path) {
+    MoveLogIndex index;
+
+    memset(writer, 0, sizeof(*writer));
+    if (movelog_index(&index, path)) {
+        if (index.damaged) {
+            fprintf(stderr, "%s has a damaged block at offset %ld; not appending\n", path,
+                    index.end);
+            movelog_index_free(&index);
+            return 0;
+        }
+        // Drop the torn block after the last complete one
+        FILE *file = fopen(path, "rb");
+        long size = file && fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+        if (file) {
+            fclose(file);
+        }
+        if (size > index.end && !truncate_log(path, index.end)) {
+            fprintf(stderr, "Cannot drop the torn block at the end of %s\n", path);
+            movelog_index_free(&index);
+            return 0;
+        }
+        writer->next_game = index.games;
+        movelog_index_free(&index);
+    } else {
+        // Never overwrite a file that exists but is not a move log
+        FILE *file = fopen(path, "rb");
+        if (file) {
+            fclose(file);
+            fprintf(stderr, "%s is not a move log\n", path);
+            return 0;
+        }
+
+        MoveLogFileHeader header = {{0}, MOVELOG_VERSION, 0};
+        memcpy(header.magic, movelog_magic, sizeof(movelog_magic));
+        file = fopen(path, "wb");
+        int ok = file && fwrite(&header, sizeof(header), 1, file) == 1;
+        if (file) {
+            ok = fclose(file) == 0 && ok;
+        }
+        if (!ok) {
+            return 0;
+        }
+    }
+
+    writer->file = fopen(path, "ab");
+    return writer->file != NULL;
+}
+
+int movelog_writer_append(MoveLogWriter *writer, const MoveLogGame *game) {
+    size_t bound = encoded_bound(game);
+
+    if (bound > MOVELOG_MAX_BLOCK_BYTES) {
+        return 0;
+    }
+    if (writer->used > 0 && writer->used + bound > MOVELOG_BLOCK_BYTES &&
+        !movelog_writer_flush(writer)) {
+        return 0;
+    }
+    if (writer->used + bound > writer->capacity) {
+        size_t capacity = writer->used + bound > MOVELOG_BLOCK_BYTES ? writer->used + bound
+                                                                     : MOVELOG_BLOCK_BYTES;
+        uint8_t *block = realloc(writer->block, capacity);
+        if (!block) {
+            return 0;
+        }
+        writer->block = block;
+        writer->capacity = capacity;
+    }
+
+    writer->used += encode_game(game, writer->block + writer->used);
+    writer->games++;
+    return writer->used < MOVELOG_BLOCK_BYTES || movelog_writer_flush(writer);
+}
+
+int movelog_writer_flush(MoveLogWriter *writer) {
+    if (writer->games == 0) {
+        return 1;
+    }
+
+    MoveLogBlockHeader header = {{0}, writer->games, (uint32_t)writer->used, 0,
+                                 writer->next_game, 0};
+    memcpy(header.magic, block_magic, sizeof(block_magic));
+    header.checksum = block_checksum(&header, writer->block);
+
+    // A short write leaves a torn block, which the next open drops
+    int ok = fwrite(&header, sizeof(header), 1, writer->file) == 1 &&
+             fwrite(writer->block, 1, writer->used, writer->file) == writer->used &&
+             fflush(writer->file) == 0;
+    writer->next_game += writer->games;
+    writer->games = 0;
+    writer->used = 0;
+    return ok;
+}
+
+int movelog_writer_close(MoveLogWriter *writer) {
+    int ok = 1;
+
+    if (writer->file) {
+        ok = movelog_writer_flush(writer);
+        ok = fclose(writer->file) == 0 && ok;
+    }
+    free(writer->block);
+    memset(writer, 0, sizeof(*writer));
+    return ok;
+}
+
+// Reader
+
+int movelog_reader_open(MoveLogReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->file = open_log(path);
+    return reader->file != NULL;
+}
+
+void movelog_reader_close(MoveLogReader *reader) {
+    if (reader->file) {
+        fclose(reader->file);
+    }
+    free(reader->block);
+    memset(reader, 0, sizeof(*reader));
+}
+
+// Load the next block that passes its checksum; 0 at the end of the file
+// or at a header too damaged to find the block after it (counted)
+static int read_block(MoveLogReader *reader) {
+    MoveLogBlockHeader header;
+
+    for (;;) {
+        if (fread(&header, sizeof(header), 1, reader->file) != 1) {
+            return 0;
+        }
+        if (!valid_block_header(&header)) {
+            reader->damaged++;
+            return 0;
+        }
+        if (header.bytes > reader->capacity) {
+            uint8_t *block = realloc(reader->block, header.bytes);
+            if (!block) {
+                return 0;
+            }
+            reader->block = block;
+            reader->capacity = header.bytes;
+        }
+        if (fread(reader->block, 1, header.bytes, reader->file) != header.bytes) {
+            return 0;  // Torn by a crash while appending
+        }
+        if (block_checksum(&header, reader->block) == header.checksum) {
+            break;
+        }
+        reader->damaged++;
+    }
+
+    reader->bytes = header.bytes;
+    reader->pos = 0;
+    reader->games_left = header.games;
+    reader->next_game = header.first_game;
+    return 1;
+}
+
+int movelog_reader_seek(MoveLogReader *reader, const MoveLogIndex *index, uint64_t game) {
+    size_t low = 0, high = index->count;
+
+    if (game >= index->games) {
+        return 0;
+    }
+    // Last block starting at or before the game
+    while (high - low > 1) {
+        size_t mid = (low + high) / 2;
+        if (index->blocks[mid].first_game <= game) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    // read_block passes over a block failing its checksum; the game is lost
+    // then, and the block read in its place holds other games
+    reader->games_left = 0;
+    if (fseek(reader->file, index->blocks[low].offset, SEEK_SET) != 0 || !read_block(reader) ||
+        reader->next_game != index->blocks[low].first_game) {
+        return 0;
+    }
+    for (uint64_t skip = game - index->blocks[low].first_game; skip > 0; skip--) {
+        if (reader->games_left == 0 || !decode_game(reader->block, reader->bytes, &reader->pos, NULL)) {
+            return 0;
+        }
+        reader->games_left--;
+        reader->next_game++;
+    }
+    return 1;
+}
+
+int movelog_reader_next(MoveLogReader *reader, MoveLogGame *game) {
+    for (;;) {
+        if (reader->games_left == 0) {
+            if (!read_block(reader)) {
+                return 0;
+            }
+            continue;
+        }
+        reader->games_left--;
+        if (decode_game(reader->block, reader->bytes, &reader->pos, game)) {
+            reader->next_game++;
+            return 1;
+        }
+        // Checksum matched but the games do not parse: give up on the block
+        reader->damaged++;
+        reader->games_left = 0;
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "board.h"
+
+// Move log: every game played, as the seed and board it started from and
+// the moves made, appended to one file. A move is the direction the empty
+// cell travelled (MoveDirection), two bits on disk. Games are grouped into
+// checksummed blocks whose headers are enough to skip them, so an index is
+// built by hopping from header to header and a reader streams one block at
+// a time whatever the size of the file.
+#define MOVELOG_VERSION 1
+#define MOVELOG_BLOCK_BYTES 65536            // A block is written once this full
+#define MOVELOG_MAX_BLOCK_BYTES (64u << 20)  // Anything larger is damage
+
+// Game flags
+#define MOVELOG_SOLVED 1    // Ended on the goal
+#define MOVELOG_ASSISTED 2  // A hint was shown or auto-solve played some of the moves
+
+// On-disk headers (little-endian). The file header is followed by blocks,
+// each a block header and its games.
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+} MoveLogFileHeader;
+
+typedef struct {
+    char magic[4];
+    uint32_t games;
+    uint32_t bytes;       // Payload after this header
+    uint32_t reserved;
+    uint64_t first_game;  // Games in the blocks before this one
+    uint64_t checksum;    // pdb_checksum of the payload
+} MoveLogBlockHeader;
+
+// One game in memory, one byte per move; the struct must start zeroed
+typedef struct {
+    uint64_t seed;         // Seed the start board was drawn from, 0 if none
+    Board start;
+    uint8_t *moves;
+    size_t move_count;
+    size_t move_capacity;
+    uint32_t duration_ms;
+    uint32_t flags;
+} MoveLogGame;
+
+int movelog_game_begin(MoveLogGame *game, const Board *start, uint64_t seed);
+int movelog_game_add(MoveLogGame *game, int dir);
+void movelog_game_free(MoveLogGame *game);
+
+// Play the moves from the start board; returns 0 at the first move that
+// would leave the board, with the board as it was before that move
+int movelog_game_replay(const MoveLogGame *game, Board *board);
+
+// Block offsets from the headers alone (checksums are left to the reader);
+// end is where the last complete block stops. What follows it is either a
+// torn tail (a partial header, or a payload running past the end of the
+// file) or, when damaged is set, a bad block header with more data behind it
+typedef struct {
+    long offset;
+    uint64_t first_game;
+    uint32_t games;
+} MoveLogBlock;
+
+typedef struct {
+    MoveLogBlock *blocks;
+    size_t count;
+    uint64_t games;
+    long end;
+    int damaged;
+} MoveLogIndex;
+
+int movelog_index(MoveLogIndex *index, const char *path);
+void movelog_index_free(MoveLogIndex *index);
+
+// Appending writer: games are buffered into a block and written when it
+// fills or on flush. Opening creates the file, or drops a block left torn
+// by a crash so new blocks follow the last complete one; it refuses a log
+// with a damaged header in the middle rather than cut the games after it.
+typedef struct {
+    FILE *file;
+    uint8_t *block;
+    size_t used;
+    size_t capacity;
+    uint32_t games;        // Games buffered in the block
+    uint64_t next_game;    // Number of the first buffered game
+} MoveLogWriter;
+
+int movelog_writer_open(MoveLogWriter *writer, const char *path);
+int movelog_writer_append(MoveLogWriter *writer, const MoveLogGame *game);
+int movelog_writer_flush(MoveLogWriter *writer);
+int movelog_writer_close(MoveLogWriter *writer);
+
+// Streaming reader: holds one block at a time. Blocks failing their
+// checksum are skipped and counted; a damaged block header is counted and
+// ends the log, since the blocks after it cannot be found.
+typedef struct {
+    FILE *file;
+    uint8_t *block;
+    size_t capacity;
+    size_t bytes;
+    size_t pos;
+    uint32_t games_left;   // Games still to decode in the current block
+    uint64_t next_game;
+    uint64_t damaged;      // Blocks skipped
+} MoveLogReader;
+
+int movelog_reader_open(MoveLogReader *reader, const char *path);
+void movelog_reader_close(MoveLogReader *reader);
+
+// Position the reader so the next game read is the given one; returns 0
+// when there is no such game or its block is damaged (reader->damaged set)
+int movelog_reader_seek(MoveLogReader *reader, const MoveLogIndex *index, uint64_t game);
+
+// Next game into a reusable record; returns 0 at the end of the log
+int movelog_reader_next(MoveLogReader *reader, MoveLogGame *game);
+
+#endif // MOVELOG_H
@@ -0,0 +1,349 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "pdb.h"
+
+static const char pdb_magic[8] = {'T', 'Q', 'P', 'D', 'B', 0, 0, 0};
+
+// Tables start on page boundaries so each one maps cleanly
+#define PDB_TABLE_ALIGN 4096
+
+uint64_t pdb_entry_count(int cells, int tile_count) {
+    return rank_count(cells, tile_count);
+}
+
+uint64_t pdb_checksum(const void *data, size_t length, uint64_t seed) {
+    const uint8_t *bytes = data;
+    uint64_t hash = seed ? seed : 0xCBF29CE484222325ULL;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static uint64_t header_checksum(const PdbFileHeader *header) {
+    return pdb_checksum(header, offsetof(PdbFileHeader, header_checksum), 0);
+}
+
+int pdb_partition(int size, const char *name, int *pattern_count,
+                  int tile_counts[PDB_MAX_PATTERNS],
+                  uint8_t tiles[PDB_MAX_PATTERNS][PDB_MAX_PATTERN_TILES]) {
+    // Each partition lists its patterns back to back, 0 ends a pattern
+    static const struct {
+        int size;
+        const char *name;
+        uint8_t tiles[40];
+    } partitions[] = {
+        {4, "6-6-3", {1, 5, 6, 9, 10, 13, 0,
+                      7, 8, 11, 12, 14, 15, 0,
+                      2, 3, 4, 0}},
+        {4, "7-8", {1, 2, 3, 4, 5, 6, 7, 8, 0,
+                    9, 10, 11, 12, 13, 14, 15, 0}},
+        {5, "6-6-6-6", {1, 2, 3, 6, 7, 8, 0,
+                        4, 5, 9, 10, 14, 15, 0,
+                        11, 12, 16, 17, 21, 22, 0,
+                        13, 18, 19, 20, 23, 24, 0}}
+    };
+
+    for (size_t p = 0; p < sizeof(partitions) / sizeof(partitions[0]); p++) {
+        if (partitions[p].size != size || strcmp(partitions[p].name, name) != 0) {
+            continue;
+        }
+
+        int count = 0;
+        int covered = 0;
+        *pattern_count = 0;
+        for (int i = 0; covered < size * size - 1; i++) {
+            uint8_t tile = partitions[p].tiles[i];
+            if (tile == 0) {
+                tile_counts[(*pattern_count)++] = count;
+                count = 0;
+            } else {
+                tiles[*pattern_count][count++] = tile;
+                covered++;
+            }
+        }
+        tile_counts[(*pattern_count)++] = count;
+        return 1;
+    }
+    return 0;
+}
+
+int pdb_open(PdbSet *set, const char *path) {
+    memset(set, 0, sizeof(*set));
+
+    if (!map_file(&set->file, path)) {
+        return 0;
+    }
+    const uint8_t *base = set->file.data;
+
+    const PdbFileHeader *header = (const PdbFileHeader *)base;
+    if (set->file.size < sizeof(PdbFileHeader) ||
+        memcmp(header->magic, pdb_magic, sizeof(pdb_magic)) != 0 ||
+        header->version != PDB_FILE_VERSION ||
+        header->header_checksum != header_checksum(header) ||
+        header->board_size < 3 || header->board_size > PACKED_MAX_SIZE ||
+        header->pattern_count < 1 || header->pattern_count > PDB_MAX_PATTERNS) {
+        fprintf(stderr, "Invalid pattern database: %s\n", path);
+        pdb_close(set);
+        return 0;
+    }
+
+    int cells = (int)(header->board_size * header->board_size);
+    set->size = (int)header->board_size;
+    set->pattern_count = (int)header->pattern_count;
+
+    for (int p = 0; p < set->pattern_count; p++) {
+        PdbPattern *pattern = &set->patterns[p];
+        pattern->tile_count = header->tile_counts[p];
+        if (pattern->tile_count < 1 || pattern->tile_count > PDB_MAX_PATTERN_TILES ||
+            header->entries[p] != pdb_entry_count(cells, pattern->tile_count) ||
+            header->offsets[p] + (header->entries[p] + 1) / 2 > set->file.size) {
+            fprintf(stderr, "Corrupt pattern table %d in %s\n", p, path);
+            pdb_close(set);
+            return 0;
+        }
+        memcpy(pattern->tiles, header->tiles[p], sizeof(pattern->tiles));
+        pattern->entries = header->entries[p];
+        pattern->table = (const uint8_t *)base + header->offsets[p];
+    }
+    return 1;
+}
+
+void pdb_close(PdbSet *set) {
+    unmap_file(&set->file);
+    memset(set, 0, sizeof(*set));
+}
+
+int pdb_verify(const PdbSet *set) {
+    const PdbFileHeader *header = set->file.data;
+    uint64_t checksum = 0;
+
+    if (!header) {
+        return 0;
+    }
+    for (int p = 0; p < set->pattern_count; p++) {
+        checksum = pdb_checksum(set->patterns[p].table,
+                                (size_t)((set->patterns[p].entries + 1) / 2), checksum);
+    }
+    return checksum == header->payload_checksum;
+}
+
+// Generation
+// The search runs over (placement, blank region) pairs: non-pattern tiles
+// are indistinguishable, so every blank cell reachable without moving a
+// pattern tile is the same abstract state. Each step moves one pattern tile,
+// so a plain breadth-first search from the goal yields exact pattern costs.
+
+typedef struct {
+    uint64_t *states;
+    size_t count;
+    size_t capacity;
+} StateQueue;
+
+static int queue_push(StateQueue *queue, uint64_t state) {
+    if (queue->count == queue->capacity) {
+        size_t capacity = queue->capacity ? queue->capacity * 2 : 4096;
+        uint64_t *states = realloc(queue->states, capacity * sizeof(uint64_t));
+        if (!states) {
+            return 0;
+        }
+        queue->states = states;
+        queue->capacity = capacity;
+    }
+    queue->states[queue->count++] = state;
+    return 1;
+}
+
+static uint32_t flood_region(uint32_t start, uint32_t open, const uint32_t *neighbors) {
+    uint32_t region = start;
+    uint32_t frontier = start;
+
+    while (frontier) {
+        uint32_t grown = 0;
+        for (uint32_t rest = frontier; rest; rest &= rest - 1) {
+            grown |= neighbors[__builtin_ctz(rest)];
+        }
+        frontier = grown & open & ~region;
+        region |= frontier;
+    }
+    return region;
+}
+
+int pdb_build(int size, int tile_count, const uint8_t *tiles, uint8_t *table, FILE *log) {
+    int cells = size * size;
+    uint64_t entries = pdb_entry_count(cells, tile_count);
+    uint32_t neighbors[PACKED_MAX_CELLS];
+    uint32_t all_cells = (1u << cells) - 1;
+
+    for (int cell = 0; cell < cells; cell++) {
+        int x = cell % size, y = cell / size;
+        neighbors[cell] = 0;
+        if (x > 0) neighbors[cell] |= 1u << (cell - 1);
+        if (x < size - 1) neighbors[cell] |= 1u << (cell + 1);
+        if (y > 0) neighbors[cell] |= 1u << (cell - size);
+        if (y < size - 1) neighbors[cell] |= 1u << (cell + size);
+    }
+
+    uint8_t *cost = malloc((size_t)entries);
+    uint8_t *visited = calloc((size_t)((entries * (uint64_t)cells + 7) / 8), 1);
+    StateQueue current = {0}, next = {0};
+    if (!cost || !visited) {
+        free(cost);
+        free(visited);
+        return 0;
+    }
+    memset(cost, 0xFF, (size_t)entries);
+
+    // Goal: every pattern tile home, blank in the last cell
+    uint8_t positions[PDB_MAX_PATTERN_TILES];
+    uint32_t occupied = 0;
+    for (int i = 0; i < tile_count; i++) {
+        positions[i] = (uint8_t)(tiles[i] - 1);
+        occupied |= 1u << positions[i];
+    }
+    uint32_t region = flood_region(1u << (cells - 1), all_cells & ~occupied, neighbors);
+    uint64_t index = pdb_index(positions, tile_count, cells);
+    uint64_t state = index * (uint64_t)cells + (uint64_t)__builtin_ctz(region);
+    cost[index] = 0;
+    visited[state >> 3] |= (uint8_t)(1u << (state & 7));
+    int ok = queue_push(&current, state);
+
+    for (int depth = 0; ok && current.count > 0; depth++) {
+        if (log) {
+            fprintf(log, "  depth %3d: %zu states\n", depth, current.count);
+            fflush(log);
+        }
+        next.count = 0;
+
+        for (size_t s = 0; ok && s < current.count; s++) {
+            uint64_t placement = current.states[s] / (uint64_t)cells;
+            int blank = (int)(current.states[s] % (uint64_t)cells);
+
+            unrank_partial(placement, positions, tile_count, cells);
+            occupied = 0;
+            for (int i = 0; i < tile_count; i++) {
+                occupied |= 1u << positions[i];
+            }
+            uint32_t open = all_cells & ~occupied;
+            region = flood_region(1u << blank, open, neighbors);
+
+            // Slide any pattern tile bordering the region into it
+            for (int i = 0; ok && i < tile_count; i++) {
+                int from = positions[i];
+                for (uint32_t targets = neighbors[from] & region; targets; targets &= targets - 1) {
+                    int to = __builtin_ctz(targets);
+                    positions[i] = (uint8_t)to;
+
+                    uint32_t child_open = (open & ~(1u << to)) | (1u << from);
+                    uint32_t child_region = flood_region(1u << from, child_open, neighbors);
+                    uint64_t child_index = pdb_index(positions, tile_count, cells);
+                    uint64_t child = child_index * (uint64_t)cells +
+                                     (uint64_t)__builtin_ctz(child_region);
+
+                    if (!(visited[child >> 3] & (1u << (child & 7)))) {
+                        visited[child >> 3] |= (uint8_t)(1u << (child & 7));
+                        if (cost[child_index] == 0xFF) {
+                            cost[child_index] = (uint8_t)(depth + 1);
+                        }
+                        ok = queue_push(&next, child);
+                    }
+                }
+                positions[i] = (uint8_t)from;
+            }
+        }
+
+        StateQueue swap = current;
+        current = next;
+        next = swap;
+    }
+
+    // Store the excess over the pattern's Manhattan distance as nibbles
+    if (ok) {
+        memset(table, 0, (size_t)((entries + 1) / 2));
+        for (uint64_t i = 0; i < entries; i++) {
+            int manhattan = 0;
+            unrank_partial(i, positions, tile_count, cells);
+            for (int t = 0; t < tile_count; t++) {
+                int dx = positions[t] % size - (tiles[t] - 1) % size;
+                int dy = positions[t] / size - (tiles[t] - 1) / size;
+                manhattan += (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+            }
+            int excess = (cost[i] - manhattan) / 2;
+            if (excess > 15) {
+                excess = 15;
+            }
+            table[i >> 1] |= (uint8_t)(excess << ((i & 1) * 4));
+        }
+    }
+
+    free(current.states);
+    free(next.states);
+    free(visited);
+    free(cost);
+    return ok;
+}
+
+int pdb_write(const char *path, int size, int pattern_count,
+              const int tile_counts[PDB_MAX_PATTERNS],
+              const uint8_t tiles[PDB_MAX_PATTERNS][PDB_MAX_PATTERN_TILES],
+              uint8_t *const tables[PDB_MAX_PATTERNS]) {
+    PdbFileHeader header;
+    int cells = size * size;
+    uint64_t offset = PDB_TABLE_ALIGN;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, pdb_magic, sizeof(pdb_magic));
+    header.version = PDB_FILE_VERSION;
+    header.board_size = (uint32_t)size;
+    header.pattern_count = (uint32_t)pattern_count;
+
+    for (int p = 0; p < pattern_count; p++) {
+        uint64_t bytes = (pdb_entry_count(cells, tile_counts[p]) + 1) / 2;
+        header.tile_counts[p] = (uint8_t)tile_counts[p];
+        memcpy(header.tiles[p], tiles[p], PDB_MAX_PATTERN_TILES);
+        header.entries[p] = pdb_entry_count(cells, tile_counts[p]);
+        header.offsets[p] = offset;
+        header.payload_checksum = pdb_checksum(tables[p], (size_t)bytes, header.payload_checksum);
+        offset = (offset + bytes + PDB_TABLE_ALIGN - 1) / PDB_TABLE_ALIGN * PDB_TABLE_ALIGN;
+    }
+    header.header_checksum = header_checksum(&header);
+
+    // Write beside the target and rename so readers never map a partial file
+    char temp_path[1024];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE *file = fopen(temp_path, "wb");
+    if (!file) {
+        return 0;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int p = 0; ok && p < pattern_count; p++) {
+        uint64_t bytes = (header.entries[p] + 1) / 2;
+        ok = fseek(file, (long)header.offsets[p], SEEK_SET) == 0 &&
+             fwrite(tables[p], 1, (size_t)bytes, file) == (size_t)bytes;
+    }
+    // Pad the last table out to its page so the file size is aligned too
+    if (ok && pattern_count > 0) {
+        uint64_t end = header.offsets[pattern_count - 1] + (header.entries[pattern_count - 1] + 1) / 2;
+        uint64_t padded = (end + PDB_TABLE_ALIGN - 1) / PDB_TABLE_ALIGN * PDB_TABLE_ALIGN;
+        ok = padded == end || (fseek(file, (long)(padded - 1), SEEK_SET) == 0 && fputc(0, file) != EOF);
+    }
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok) {
+#ifdef _WIN32
+        remove(path);
+#endif
+        ok = rename(temp_path, path) == 0;
+    }
+    if (!ok) {
+        remove(temp_path);
+    }
+    return ok;
+}
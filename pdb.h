@@ -0,0 +1,86 @@
+#ifndef PDB_H
+#define PDB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "bitboard.h"
+#include "mapfile.h"
+#include "rank.h"
+
+// Pattern database limits
+#define PDB_MAX_PATTERNS 4
+#define PDB_MAX_PATTERN_TILES 8
+#define PDB_FILE_VERSION 1
+
+// One pattern: a set of tiles whose joint placement indexes a nibble table.
+// Each nibble holds (moves of pattern tiles - their Manhattan distance) / 2,
+// which is always a whole number and rarely exceeds 15.
+typedef struct {
+    int tile_count;
+    uint8_t tiles[PDB_MAX_PATTERN_TILES];
+    uint64_t entries;
+    const uint8_t *table;
+} PdbPattern;
+
+// Disjoint patterns covering every tile of one board size; their values add
+typedef struct {
+    int size;
+    int pattern_count;
+    PdbPattern patterns[PDB_MAX_PATTERNS];
+
+    // Mapping backing the tables
+    MappedFile file;
+} PdbSet;
+
+// On-disk header (little-endian, tables follow at the given offsets)
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t board_size;
+    uint32_t pattern_count;
+    uint32_t reserved;
+    uint8_t tile_counts[PDB_MAX_PATTERNS];
+    uint8_t tiles[PDB_MAX_PATTERNS][PDB_MAX_PATTERN_TILES];
+    uint64_t offsets[PDB_MAX_PATTERNS];
+    uint64_t entries[PDB_MAX_PATTERNS];
+    uint64_t payload_checksum;
+    uint64_t header_checksum;
+} PdbFileHeader;
+
+// Map a database file read-only; only the header checksum is checked here
+// so opening stays instant, pdb_verify() checks the tables themselves
+int pdb_open(PdbSet *set, const char *path);
+void pdb_close(PdbSet *set);
+int pdb_verify(const PdbSet *set);
+
+// Number of placements of k tiles on n cells: n! / (n - k)!
+uint64_t pdb_entry_count(int cells, int tile_count);
+
+// FNV-1a over a byte range, used for both file checksums
+uint64_t pdb_checksum(const void *data, size_t length, uint64_t seed);
+
+// Generation: breadth-first search back from the goal for one pattern,
+// writing (entries + 1) / 2 bytes of nibbles; progress goes to log if set
+int pdb_build(int size, int tile_count, const uint8_t *tiles, uint8_t *table, FILE *log);
+int pdb_write(const char *path, int size, int pattern_count,
+              const int tile_counts[PDB_MAX_PATTERNS],
+              const uint8_t tiles[PDB_MAX_PATTERNS][PDB_MAX_PATTERN_TILES],
+              uint8_t *const tables[PDB_MAX_PATTERNS]);
+
+// Standard partitions by name ("6-6-3" and "7-8" for 4x4, "6-6-6-6" for 5x5)
+int pdb_partition(int size, const char *name, int *pattern_count,
+                  int tile_counts[PDB_MAX_PATTERNS],
+                  uint8_t tiles[PDB_MAX_PATTERNS][PDB_MAX_PATTERN_TILES]);
+
+// Dense index of a pattern placement (cell of each pattern tile, in order)
+static inline uint64_t pdb_index(const uint8_t *positions, int tile_count, int cells) {
+    return rank_partial(positions, tile_count, cells);
+}
+
+// Stored nibble for an index
+static inline int pdb_nibble(const PdbPattern *pattern, uint64_t index) {
+    return (pattern->table[index >> 1] >> ((index & 1) * 4)) & 0xF;
+}
+
+#endif // PDB_H
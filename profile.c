@@ -0,0 +1,201 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <time.h>
+#include "profile.h"
+
+#if TAQUIN_PROFILE
+
+// Slots are whole cache lines apart, so no two writers share one
+typedef struct {
+    ProfileHistogram zones[PROFILE_ZONE_COUNT];
+    int owned;
+} __attribute__((aligned(64))) ProfileThread;
+
+static ProfileThread profile_threads[PROFILE_MAX_THREADS];
+static __thread ProfileThread *profile_self;
+static uint64_t dropped;
+
+// Clock and tick counter read together at profile_init
+static uint64_t anchor_ns, anchor_ticks;
+
+static const char *zone_names[PROFILE_ZONE_COUNT] = {
+    "frame", "events", "update", "render", "input", "solve"
+};
+
+uint64_t profile_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void profile_init(void) {
+    anchor_ns = profile_clock_ns();
+    anchor_ticks = profile_ticks();
+}
+
+// Ticks per nanosecond measured over the whole run so far, so the estimate
+// sharpens the longer the program runs
+double profile_ns_per_tick(void) {
+#ifdef PROFILE_CYCLES
+    uint64_t ns = profile_clock_ns() - anchor_ns;
+    uint64_t ticks = profile_ticks() - anchor_ticks;
+    return ticks > 0 && anchor_ns ? (double)ns / (double)ticks : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+const char *profile_zone_name(ProfileZone zone) {
+    return zone_names[zone];
+}
+
+static int bucket_index(uint64_t ticks) {
+    if (ticks >> PROFILE_MAX_BITS) {
+        return PROFILE_BUCKETS - 1;
+    }
+    if (ticks < (1u << PROFILE_SUB_BITS)) {
+        return (int)ticks;
+    }
+    int bits = 63 - __builtin_clzll(ticks);
+    int shift = bits - PROFILE_SUB_BITS;
+    return ((shift + 1) << PROFILE_SUB_BITS) + (int)((ticks >> shift) & ((1u << PROFILE_SUB_BITS) - 1));
+}
+
+uint64_t profile_bucket_low(int index, uint64_t *width) {
+    int octave = index >> PROFILE_SUB_BITS;
+    uint64_t sub = (uint64_t)(index & ((1 << PROFILE_SUB_BITS) - 1));
+
+    if (octave == 0) {
+        *width = 1;
+        return sub;
+    }
+    *width = (uint64_t)1 << (octave - 1);
+    return ((1u << PROFILE_SUB_BITS) + sub) << (octave - 1);
+}
+
+// First free slot, claimed once per thread; NULL when all are taken
+static ProfileThread *claim_slot(void) {
+    for (int t = 0; t < PROFILE_MAX_THREADS; t++) {
+        int free_slot = 0;
+        if (__atomic_compare_exchange_n(&profile_threads[t].owned, &free_slot, 1, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return &profile_threads[t];
+        }
+    }
+    return NULL;
+}
+
+// Only the owner writes a slot, so a load and a store replace atomic adds;
+// they stay atomic so readers never see a torn value
+static inline void bump(uint64_t *value, uint64_t by) {
+    __atomic_store_n(value, __atomic_load_n(value, __ATOMIC_RELAXED) + by, __ATOMIC_RELAXED);
+}
+
+void profile_record(ProfileZone zone, uint64_t ticks) {
+    if (!profile_self && !(profile_self = claim_slot())) {
+        __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    ProfileHistogram *histogram = &profile_self->zones[zone];
+    bump(&histogram->buckets[bucket_index(ticks)], 1);
+    bump(&histogram->count, 1);
+    bump(&histogram->total, ticks);
+    if (ticks > histogram->max) {
+        __atomic_store_n(&histogram->max, ticks, __ATOMIC_RELAXED);
+    }
+}
+
+// The next owner adds to the same totals
+void profile_thread_exit(void) {
+    if (profile_self) {
+        __atomic_store_n(&profile_self->owned, 0, __ATOMIC_RELEASE);
+        profile_self = NULL;
+    }
+}
+
+uint64_t profile_dropped(void) {
+    return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
+
+void profile_snapshot(ProfileZone zone, ProfileHistogram *histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+    for (int t = 0; t < PROFILE_MAX_THREADS; t++) {
+        const ProfileHistogram *source = &profile_threads[t].zones[zone];
+        uint64_t count = __atomic_load_n(&source->count, __ATOMIC_RELAXED);
+        if (count == 0) {
+            continue;
+        }
+        histogram->count += count;
+        histogram->total += __atomic_load_n(&source->total, __ATOMIC_RELAXED);
+        uint64_t max = __atomic_load_n(&source->max, __ATOMIC_RELAXED);
+        histogram->max = max > histogram->max ? max : histogram->max;
+        for (int i = 0; i < PROFILE_BUCKETS; i++) {
+            histogram->buckets[i] += __atomic_load_n(&source->buckets[i], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// The maximum cannot be split; the later one is kept
+void profile_subtract(ProfileHistogram *histogram, const ProfileHistogram *earlier) {
+    histogram->count -= earlier->count;
+    histogram->total -= earlier->total;
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        histogram->buckets[i] -= earlier->buckets[i];
+    }
+}
+
+uint64_t profile_percentile(const ProfileHistogram *histogram, double fraction) {
+    uint64_t seen = 0;
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+    // Buckets are summed without a lock while threads record, so the total
+    // may run a little ahead of them; the last non-empty bucket answers then
+    uint64_t target = (uint64_t)(fraction * (double)histogram->count);
+    int last = 0;
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        if (histogram->buckets[i] == 0) {
+            continue;
+        }
+        last = i;
+        seen += histogram->buckets[i];
+        if (seen > target) {
+            break;
+        }
+    }
+    uint64_t width;
+    uint64_t low = profile_bucket_low(last, &width);
+    return low + width / 2;
+}
+
+void profile_report(FILE *out) {
+    double scale = profile_ns_per_tick() / 1000.0;
+    ProfileHistogram histogram;
+    int header = 0;
+
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+        profile_snapshot((ProfileZone)zone, &histogram);
+        if (histogram.count == 0) {
+            continue;
+        }
+        if (!header) {
+            fprintf(out, "Profile (microseconds):\n");
+            header = 1;
+        }
+        fprintf(out, "  %-7s %9llu samples  mean %10.1f  p50 %10.1f  p99 %10.1f  max %10.1f\n",
+                zone_names[zone], (unsigned long long)histogram.count,
+                (double)histogram.total / (double)histogram.count * scale,
+                (double)profile_percentile(&histogram, 0.50) * scale,
+                (double)profile_percentile(&histogram, 0.99) * scale,
+                (double)histogram.max * scale);
+    }
+    if (profile_dropped()) {
+        fprintf(out, "  %llu samples dropped, more than %d threads recording\n",
+                (unsigned long long)profile_dropped(), PROFILE_MAX_THREADS);
+    }
+}
+
+#endif // TAQUIN_PROFILE
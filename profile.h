@@ -0,0 +1,105 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Hot-path instrumentation: scoped timers feed per-thread latency
+// histograms. Time is read from the CPU's cycle counter where there is one
+// and converted to nanoseconds only when results are read, against a clock
+// sampled at profile_init(). Each thread owns a slot while it runs and
+// records into it with plain relaxed loads and stores: no lock, no
+// read-modify-write, no cache line shared with another writer. Readers
+// merge the slots at any time. A thread that exits must release its slot
+// with PROFILE_THREAD_EXIT() so a later thread can take it over.
+//
+// Build with -DTAQUIN_PROFILE=0 (make PROFILE=0) to compile every timer out.
+#ifndef TAQUIN_PROFILE
+#define TAQUIN_PROFILE 1
+#endif
+
+typedef enum {
+    PROFILE_FRAME,   // Events, update and render of one frame, present included
+    PROFILE_EVENTS,
+    PROFILE_UPDATE,
+    PROFILE_RENDER,
+    PROFILE_INPUT,   // Key or click handled to the end of the frame showing it
+    PROFILE_SOLVE,   // Background hint or auto-solve search
+    PROFILE_ZONE_COUNT
+} ProfileZone;
+
+// Log-linear buckets, as in HDR histograms: values below 16 ticks are
+// exact, above that each power of two splits into 16 buckets, so every
+// value is within 1/16 of its bucket; up to 2^48 ticks (a day at 3 GHz)
+#define PROFILE_SUB_BITS 4
+#define PROFILE_MAX_BITS 48
+#define PROFILE_BUCKETS ((PROFILE_MAX_BITS - PROFILE_SUB_BITS + 1) << PROFILE_SUB_BITS)
+
+// Threads recording at once; samples from any more are dropped and counted
+#define PROFILE_MAX_THREADS 16
+
+typedef struct {
+    uint64_t count;
+    uint64_t total;  // Ticks
+    uint64_t max;
+    uint64_t buckets[PROFILE_BUCKETS];
+} ProfileHistogram;
+
+#if TAQUIN_PROFILE
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROFILE_CYCLES 1
+#endif
+
+uint64_t profile_clock_ns(void);
+
+static inline uint64_t profile_ticks(void) {
+#ifdef PROFILE_CYCLES
+    return __rdtsc();
+#else
+    return profile_clock_ns();
+#endif
+}
+
+// Anchor tick conversion; call once at startup
+void profile_init(void);
+void profile_record(ProfileZone zone, uint64_t ticks);
+
+// Give the calling thread's slot back; its samples stay in the totals
+void profile_thread_exit(void);
+
+// Samples dropped because every slot was taken
+uint64_t profile_dropped(void);
+
+// A zone's histogram over every thread; subtract an earlier one for the
+// samples recorded since
+void profile_snapshot(ProfileZone zone, ProfileHistogram *histogram);
+void profile_subtract(ProfileHistogram *histogram, const ProfileHistogram *earlier);
+
+// Ticks at or below which the given fraction of samples fall (a bucket's
+// midpoint), 0 when empty
+uint64_t profile_percentile(const ProfileHistogram *histogram, double fraction);
+
+// Smallest value in a bucket, and the bucket's width, in ticks
+uint64_t profile_bucket_low(int index, uint64_t *width);
+
+double profile_ns_per_tick(void);
+const char *profile_zone_name(ProfileZone zone);
+
+// Count, p50, p99 and max of every zone with samples
+void profile_report(FILE *out);
+
+#define PROFILE_BEGIN(zone) uint64_t profile_start_##zone = profile_ticks()
+#define PROFILE_END(zone) profile_record(zone, profile_ticks() - profile_start_##zone)
+#define PROFILE_THREAD_EXIT() profile_thread_exit()
+
+#else
+
+#define PROFILE_BEGIN(zone) ((void)0)
+#define PROFILE_END(zone) ((void)0)
+#define PROFILE_THREAD_EXIT() ((void)0)
+
+#endif // TAQUIN_PROFILE
+
+#endif // PROFILE_H
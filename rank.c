@@ -0,0 +1,116 @@
+#include "rank.h"
+
+uint64_t rank_count(int n, int k) {
+    uint64_t count = 1;
+    for (int i = 0; i < k; i++) {
+        count *= (uint64_t)(n - i);
+    }
+    return count;
+}
+
+void unrank_partial(uint64_t rank, uint8_t *items, int k, int n) {
+    uint8_t digits[32];
+
+    for (int i = k - 1; i >= 0; i--) {
+        uint64_t radix = (uint64_t)(n - i);
+        digits[i] = (uint8_t)(rank % radix);
+        rank /= radix;
+    }
+
+    // Each digit selects among the unused items: drop that many low set
+    // bits from the free mask, then take the lowest remaining one
+    uint32_t free_items = n < 32 ? (1u << n) - 1 : ~0u;
+    for (int i = 0; i < k; i++) {
+        uint32_t mask = free_items;
+        for (int skip = digits[i]; skip > 0; skip--) {
+            mask &= mask - 1;
+        }
+        int item = __builtin_ctz(mask);
+        items[i] = (uint8_t)item;
+        free_items &= ~(1u << item);
+    }
+}
+
+// Build a board from the tile in each cell
+static void pack_tiles(PackedBoard *pb, const uint8_t *tiles, int cells) {
+    pb->words[0] = 0;
+    pb->words[1] = 0;
+    for (int cell = 0; cell < cells; cell++) {
+        if (tiles[cell] == 0) {
+            pb->empty = (uint8_t)cell;
+        }
+        packed_xor(pb, cell, tiles[cell]);
+    }
+}
+
+uint64_t rank_board(const PackedBoard *pb) {
+    uint8_t tiles[PACKED_MAX_CELLS];
+    int cells = pb->size * pb->size;
+
+    for (int cell = 0; cell < cells; cell++) {
+        tiles[cell] = (uint8_t)packed_get(pb, cell);
+    }
+    return rank_partial(tiles, cells, cells);
+}
+
+int unrank_board(PackedBoard *pb, int size, uint64_t rank) {
+    uint8_t tiles[PACKED_MAX_CELLS];
+    int cells = size * size;
+
+    if (size > RANK_MAX_BOARD_SIZE || !packed_init(pb, size) ||
+        rank >= rank_count(cells, cells)) {
+        return 0;
+    }
+    unrank_partial(rank, tiles, cells, cells);
+    pack_tiles(pb, tiles, cells);
+    return 1;
+}
+
+uint64_t rank_solvable(const PackedBoard *pb) {
+    uint8_t tiles[PACKED_MAX_CELLS];
+    int cells = pb->size * pb->size;
+    int count = 0;
+
+    for (int cell = 0; cell < cells; cell++) {
+        int tile = packed_get(pb, cell);
+        if (tile != 0) {
+            tiles[count++] = (uint8_t)(tile - 1);
+        }
+    }
+    return pb->empty * (rank_count(count, count) >> 1) + (rank_partial(tiles, count, count) >> 1);
+}
+
+int unrank_solvable(PackedBoard *pb, int size, uint64_t rank) {
+    uint8_t tiles[PACKED_MAX_CELLS];
+    uint8_t board[PACKED_MAX_CELLS];
+    int cells = size * size;
+    int count = cells - 1;
+
+    if (size > RANK_MAX_BOARD_SIZE || !packed_init(pb, size) ||
+        rank >= rank_count(cells, cells) >> 1) {
+        return 0;
+    }
+    uint64_t half = rank_count(count, count) >> 1;
+    int blank = (int)(rank / half);
+    uint64_t tiles_rank = (rank % half) << 1;
+    unrank_partial(tiles_rank, tiles, count, count);
+
+    // The Lehmer digits sum to the inversion count; solvable boards have an
+    // even count, plus the empty cell's row distance from home on even widths
+    int parity = size % 2 == 0 ? (size - 1 - blank / size) & 1 : 0;
+    for (int i = count - 1; i >= 0; i--) {
+        parity ^= (int)(tiles_rank % (uint64_t)(count - i)) & 1;
+        tiles_rank /= (uint64_t)(count - i);
+    }
+    if (parity) {
+        uint8_t tile = tiles[count - 2];
+        tiles[count - 2] = tiles[count - 1];
+        tiles[count - 1] = tile;
+    }
+
+    for (int cell = 0, i = 0; cell < cells; cell++) {
+        board[cell] = cell == blank ? 0 : (uint8_t)(tiles[i++] + 1);
+    }
+    pack_tiles(pb, board, cells);
+    return 1;
+}
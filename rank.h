@@ -0,0 +1,44 @@
+#ifndef RANK_H
+#define RANK_H
+
+#include <stdint.h>
+#include "bitboard.h"
+
+// Largest board whose full permutation rank fits in 64 bits (16! < 2^64 < 25!)
+#define RANK_MAX_BOARD_SIZE 4
+
+// Number of k-permutations of n items: n! / (n - k)!
+uint64_t rank_count(int n, int k);
+
+// Lexicographic rank of a k-permutation of {0 .. n-1}, n <= 32, in
+// [0, rank_count(n, k)). Lehmer code: each digit is the item minus the
+// number of smaller items already used, read from a bitmask by popcount.
+static inline uint64_t rank_partial(const uint8_t *items, int k, int n) {
+    uint64_t rank = 0;
+    uint32_t used = 0;
+
+    for (int i = 0; i < k; i++) {
+        int item = items[i];
+        int digit = item - __builtin_popcount(used & ((1u << item) - 1));
+        rank = rank * (uint64_t)(n - i) + (uint64_t)digit;
+        used |= 1u << item;
+    }
+    return rank;
+}
+
+// Inverse of rank_partial
+void unrank_partial(uint64_t rank, uint8_t *items, int k, int n);
+
+// Whole boards up to RANK_MAX_BOARD_SIZE, as the permutation of tiles over
+// cells: [0, 9!) for 3x3, [0, 16!) for 4x4
+uint64_t rank_board(const PackedBoard *pb);
+int unrank_board(PackedBoard *pb, int size, uint64_t rank);
+
+// Solvable boards only, dense in [0, n!/2): the empty cell times
+// (n-1)!/2 plus half the rank of the other tiles in reading order. Swapping
+// the last two of those tiles flips solvability without moving the empty
+// cell, so the pair at ranks 2r and 2r+1 holds exactly one solvable board.
+uint64_t rank_solvable(const PackedBoard *pb);
+int unrank_solvable(PackedBoard *pb, int size, uint64_t rank);
+
+#endif // RANK_H
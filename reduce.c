@@ -0,0 +1,670 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reduce.h"
+
+// Largest exact searches: placing one tile, and the last two of a line
+#define EXACT_TILE_STATES (1u << 12)
+#define EXACT_PAIR_STATES (1u << 15)
+
+// Window the last two tiles of a line are finished in: at most 3x3 cells
+#define PAIR_WINDOW_CELLS 9
+#define PAIR_STATES (PAIR_WINDOW_CELLS * PAIR_WINDOW_CELLS * PAIR_WINDOW_CELLS)
+
+typedef struct {
+    Board board;          // Working copy, solved region by region
+    uint8_t *locked;      // Cells no route may cross
+    uint16_t *queue;      // Breadth-first scratch, one entry per cell
+    int16_t *from;        // Cell each visited cell was reached from
+    uint16_t *route;      // A tile's route to its goal
+    int16_t *index;       // Unlocked cell numbering for exact searches
+    uint16_t *region;
+    uint32_t *exact_from; // Exact search scratch, grown on demand
+    uint32_t *exact_queue;
+    size_t exact_capacity;
+    MovePlan *plan;
+    SolverControl *control;
+} Reducer;
+
+void move_plan_free(MovePlan *plan) {
+    free(plan->moves);
+    memset(plan, 0, sizeof(*plan));
+}
+
+static int plan_push(MovePlan *plan, int dir) {
+    if (plan->length == plan->capacity) {
+        size_t capacity = plan->capacity ? plan->capacity * 2 : 256;
+        uint8_t *moves = realloc(plan->moves, capacity);
+        if (!moves) {
+            return 0;
+        }
+        plan->moves = moves;
+        plan->capacity = capacity;
+    }
+    plan->moves[plan->length++] = (uint8_t)dir;
+    return 1;
+}
+
+static int cell_neighbor(int size, int cell, int dir) {
+    int x = cell % size;
+    int y = cell / size;
+
+    switch (dir) {
+        case MOVE_LEFT:  return x > 0 ? cell - 1 : -1;
+        case MOVE_RIGHT: return x < size - 1 ? cell + 1 : -1;
+        case MOVE_UP:    return y > 0 ? cell - size : -1;
+        default:         return y < size - 1 ? cell + size : -1;
+    }
+}
+
+static int find_tile(const Board *board, int tile) {
+    for (int cell = 0; cell < board->cells; cell++) {
+        if (board->tiles[cell] == tile) {
+            return cell;
+        }
+    }
+    return -1;
+}
+
+// Slide the tile at an adjacent cell and record the move
+static int push_cell(Reducer *r, int cell) {
+    int dir = board_direction(&r->board, cell);
+    board_slide(&r->board, cell);
+    return plan_push(r->plan, dir);
+}
+
+// Breadth-first search over unlocked cells until target is reached, with
+// from[] leading back to start; returns target, or -1 if it is walled off
+static int flood(Reducer *r, int start, int target) {
+    int size = r->board.size;
+    size_t head = 0, tail = 0;
+
+    for (int cell = 0; cell < r->board.cells; cell++) {
+        r->from[cell] = -1;
+    }
+    r->from[start] = (int16_t)start;
+    r->queue[tail++] = (uint16_t)start;
+
+    while (head < tail) {
+        int cell = r->queue[head++];
+        if (cell == target) {
+            return cell;
+        }
+        for (int dir = 0; dir < MOVE_COUNT; dir++) {
+            int next = cell_neighbor(size, cell, dir);
+            if (next >= 0 && !r->locked[next] && r->from[next] < 0) {
+                r->from[next] = (int16_t)cell;
+                r->queue[tail++] = (uint16_t)next;
+            }
+        }
+    }
+    return -1;
+}
+
+// Walk the empty cell to target without crossing locked cells
+static int route_empty(Reducer *r, int target) {
+    if (r->board.empty == target) {
+        return 1;
+    }
+    if (flood(r, r->board.empty, target) < 0) {
+        return 0;
+    }
+
+    // The route comes out backwards; queue[] is free again to reverse it
+    int count = 0;
+    for (int cell = target; cell != r->board.empty; cell = r->from[cell]) {
+        r->queue[count++] = (uint16_t)cell;
+    }
+    while (count > 0) {
+        if (!push_cell(r, r->queue[--count])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Whether an exact search for this many tiles fits in the given states
+static int exact_fits(const Reducer *r, int count, size_t limit) {
+    int n = 0;
+    for (int cell = 0; cell < r->board.cells; cell++) {
+        n += !r->locked[cell];
+    }
+    return (size_t)n * (size_t)n * (count == 2 ? (size_t)n : 1) <= limit;
+}
+
+// Breadth-first search over the cells of one or two tiles and the empty
+// cell, within the unlocked cells: shortest, but the states number
+// cells^(count + 1), so callers keep it to small regions
+static int search_exact(Reducer *r, const int *tiles, const int *goals, int count) {
+    int size = r->board.size;
+    int n = 0;
+
+    for (int cell = 0; cell < r->board.cells; cell++) {
+        r->index[cell] = -1;
+        if (!r->locked[cell]) {
+            r->index[cell] = (int16_t)n;
+            r->region[n++] = (uint16_t)cell;
+        }
+    }
+    size_t states = (size_t)n * (size_t)n * (count == 2 ? (size_t)n : 1);
+    if (states > r->exact_capacity) {
+        free(r->exact_from);
+        free(r->exact_queue);
+        r->exact_from = malloc(states * sizeof(uint32_t));
+        r->exact_queue = malloc(states * sizeof(uint32_t));
+        r->exact_capacity = r->exact_from && r->exact_queue ? states : 0;
+        if (!r->exact_capacity) {
+            return 0;
+        }
+    }
+    for (size_t s = 0; s < states; s++) {
+        r->exact_from[s] = UINT32_MAX;
+    }
+
+    // State: tile positions then the empty cell, as base-n digits
+    uint32_t start = 0, target = 0;
+    for (int i = 0; i < count; i++) {
+        start = start * (uint32_t)n + (uint32_t)r->index[find_tile(&r->board, tiles[i])];
+        target = target * (uint32_t)n + (uint32_t)r->index[goals[i]];
+    }
+    start = start * (uint32_t)n + (uint32_t)r->index[r->board.empty];
+
+    uint32_t found = start / (uint32_t)n == target ? start : UINT32_MAX;
+    size_t head = 0, tail = 0;
+    r->exact_from[start] = start;
+    r->exact_queue[tail++] = start;
+
+    while (head < tail && found == UINT32_MAX) {
+        uint32_t state = r->exact_queue[head++];
+        uint32_t empty = state % (uint32_t)n;
+        uint32_t tile_a = state / (uint32_t)n;
+        uint32_t tile_b = count == 2 ? tile_a % (uint32_t)n : UINT32_MAX;
+        if (count == 2) {
+            tile_a /= (uint32_t)n;
+        }
+
+        for (int dir = 0; dir < MOVE_COUNT && found == UINT32_MAX; dir++) {
+            int next = cell_neighbor(size, r->region[empty], dir);
+            if (next < 0 || r->locked[next]) {
+                continue;
+            }
+            uint32_t moved = (uint32_t)r->index[next];
+            uint32_t a = tile_a == moved ? empty : tile_a;
+            uint32_t positions = a;
+            if (count == 2) {
+                positions = a * (uint32_t)n + (tile_b == moved ? empty : tile_b);
+            }
+            uint32_t child = positions * (uint32_t)n + moved;
+            if (r->exact_from[child] == UINT32_MAX) {
+                r->exact_from[child] = state;
+                r->exact_queue[tail++] = child;
+                if (positions == target) {
+                    found = child;
+                }
+            }
+        }
+    }
+    if (found == UINT32_MAX) {
+        return 0;
+    }
+
+    // Empty cells along the way, reversed into order
+    size_t steps = 0;
+    for (uint32_t s = found; s != start; s = r->exact_from[s]) {
+        r->exact_queue[steps++] = r->region[s % (uint32_t)n];
+    }
+    while (steps > 0) {
+        if (!push_cell(r, (int)r->exact_queue[--steps])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Bring a tile to an unlocked cell: exactly while the unsolved region is
+// small, otherwise along the tile's own shortest route, stepping the empty
+// cell round in front of it each time
+static int move_tile(Reducer *r, int tile, int goal) {
+    int pos = find_tile(&r->board, tile);
+
+    if (pos == goal) {
+        return 1;
+    }
+    if (exact_fits(r, 1, EXACT_TILE_STATES)) {
+        return search_exact(r, &tile, &goal, 1);
+    }
+    if (flood(r, goal, pos) < 0) {
+        return 0;
+    }
+    int steps = 0;
+    for (int cell = r->from[pos]; cell != goal; cell = r->from[cell]) {
+        r->route[steps++] = (uint16_t)cell;
+    }
+    r->route[steps++] = (uint16_t)goal;
+
+    for (int i = 0; i < steps; i++) {
+        int next = r->route[i];
+        r->locked[pos] = 1;
+        int ok = route_empty(r, next);
+        r->locked[pos] = 0;
+        if (!ok) {
+            return search_exact(r, &tile, &goal, 1);
+        }
+        if (!push_cell(r, pos)) {
+            return 0;
+        }
+        pos = next;
+    }
+    return 1;
+}
+
+// Finish two tiles together inside a window of cells holding both tiles
+// and the empty cell: breadth-first over their three positions
+static int solve_window(Reducer *r, const int *window, int count, int a, int goal_a,
+                        int b, int goal_b) {
+    int16_t from[PAIR_STATES];
+    uint16_t queue[PAIR_STATES];
+    int index[BOARD_MAX_CELLS];
+    size_t head = 0, tail = 0;
+
+    for (int i = 0; i < count; i++) {
+        index[window[i]] = i;
+    }
+    for (int s = 0; s < PAIR_STATES; s++) {
+        from[s] = -1;
+    }
+    int ia = index[find_tile(&r->board, a)];
+    int ib = index[find_tile(&r->board, b)];
+    int start = (ia * PAIR_WINDOW_CELLS + ib) * PAIR_WINDOW_CELLS + index[r->board.empty];
+    int target_a = index[goal_a], target_b = index[goal_b];
+    int found = -1;
+
+    from[start] = (int16_t)start;
+    queue[tail++] = (uint16_t)start;
+    while (head < tail && found < 0) {
+        int state = queue[head++];
+        int pa = state / (PAIR_WINDOW_CELLS * PAIR_WINDOW_CELLS);
+        int pb = state / PAIR_WINDOW_CELLS % PAIR_WINDOW_CELLS;
+        int pe = state % PAIR_WINDOW_CELLS;
+        if (pa == target_a && pb == target_b) {
+            found = state;
+            break;
+        }
+        for (int n = 0; n < count; n++) {
+            if (board_distance(&r->board, window[n], window[pe]) != 1) {
+                continue;
+            }
+            int na = pa == n ? pe : pa;
+            int nb = pb == n ? pe : pb;
+            int child = (na * PAIR_WINDOW_CELLS + nb) * PAIR_WINDOW_CELLS + n;
+            if (from[child] < 0) {
+                from[child] = (int16_t)state;
+                queue[tail++] = (uint16_t)child;
+            }
+        }
+    }
+    if (found < 0) {
+        return 0;
+    }
+
+    int steps = 0;
+    for (int s = found; s != start; s = from[s]) {
+        queue[steps++] = (uint16_t)window[s % PAIR_WINDOW_CELLS];
+    }
+    while (steps > 0) {
+        if (!push_cell(r, queue[--steps])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Last two cells of a line (goal_a beside the corner, goal_b in it): the
+// tiles are staged side by side two lines away, where neither can wall the
+// other into a dead end, the empty cell joins them and the 3x3 window whose
+// corner is (x0, y0) is searched for the finish
+static int place_pair(Reducer *r, int goal_a, int goal_b, int x0, int y0,
+                      int stage_a, int stage_b) {
+    int size = r->board.size;
+    int a = board_goal(&r->board, goal_a);
+    int b = board_goal(&r->board, goal_b);
+    int window[PAIR_WINDOW_CELLS];
+    int count = 0;
+
+    if (exact_fits(r, 2, EXACT_PAIR_STATES)) {
+        int tiles[2] = {a, b};
+        int goals[2] = {goal_a, goal_b};
+        if (!search_exact(r, tiles, goals, 2)) {
+            return 0;
+        }
+    } else if (r->board.tiles[goal_a] != a || r->board.tiles[goal_b] != b) {
+        for (int y = y0; y < y0 + 3; y++) {
+            for (int x = x0; x < x0 + 3; x++) {
+                if (!r->locked[y * size + x]) {
+                    window[count++] = y * size + x;
+                }
+            }
+        }
+
+        int ok = move_tile(r, a, stage_a);
+        r->locked[stage_a] = 1;
+        ok = ok && move_tile(r, b, stage_b);
+        r->locked[stage_b] = 1;
+
+        int in_window = 0;
+        for (int i = 0; i < count; i++) {
+            in_window |= window[i] == r->board.empty;
+        }
+        if (ok && !in_window) {
+            int target = 0;
+            while (window[target] == stage_a || window[target] == stage_b) {
+                target++;
+            }
+            ok = route_empty(r, window[target]);
+        }
+        r->locked[stage_a] = 0;
+        r->locked[stage_b] = 0;
+
+        if (!ok || !solve_window(r, window, count, a, goal_a, b, goal_b)) {
+            return 0;
+        }
+    }
+    r->locked[goal_a] = 1;
+    r->locked[goal_b] = 1;
+    return 1;
+}
+
+static int cancelled(const Reducer *r) {
+    return r->control && __atomic_load_n(&r->control->cancel, __ATOMIC_RELAXED);
+}
+
+// Top row then left column of the unsolved square whose corner is (k, k)
+static int reduce_square(Reducer *r, int k) {
+    int size = r->board.size;
+
+    for (int x = k; x < size - 2; x++) {
+        int cell = k * size + x;
+        if (cancelled(r) || !move_tile(r, board_goal(&r->board, cell), cell)) {
+            return 0;
+        }
+        r->locked[cell] = 1;
+    }
+    if (!place_pair(r, k * size + size - 2, k * size + size - 1, size - 3, k,
+                    (k + 2) * size + size - 2, (k + 2) * size + size - 1)) {
+        return 0;
+    }
+
+    for (int y = k + 1; y < size - 2; y++) {
+        int cell = y * size + k;
+        if (cancelled(r) || !move_tile(r, board_goal(&r->board, cell), cell)) {
+            return 0;
+        }
+        r->locked[cell] = 1;
+    }
+    return place_pair(r, (size - 2) * size + k, (size - 1) * size + k, k, size - 3,
+                      (size - 2) * size + k + 2, (size - 1) * size + k + 2);
+}
+
+// The unsolved bottom-right n x n square renumbered as a board of its own;
+// its moves carry over unchanged
+static int corner_board(const Board *board, int n, PackedBoard *packed) {
+    int size = board->size;
+    int origin = size - n;
+    Board small = {0};
+    int ok = board_init(&small, n);
+
+    for (int y = 0; ok && y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            int tile = board_at(board, origin + x, origin + y);
+            int local = 0;
+            if (tile) {
+                int goal = tile - 1;
+                local = (goal / size - origin) * n + goal % size - origin + 1;
+            }
+            small.tiles[y * n + x] = (uint16_t)local;
+            if (!tile) {
+                small.empty = y * n + x;
+            }
+        }
+    }
+    if (ok) {
+        board_recount(&small);
+        ok = board_to_packed(&small, packed);
+    }
+    board_free(&small);
+    return ok;
+}
+
+// The last 3x3, solved optimally
+static int finish_square(Reducer *r) {
+    PackedBoard packed;
+    SolverResult result;
+    int ok = corner_board(&r->board, 3, &packed) && solver_solve(&packed, &result);
+
+    for (int i = 0; ok && i < result.length; i++) {
+        ok = push_cell(r, cell_neighbor(r->board.size, r->board.empty, result.moves[i]));
+    }
+    return ok;
+}
+
+// Weighted search over the last 4x4 (its state when the reduction reached
+// it, and the plan length then); keeps the result if it beats the reduction
+static int polish_tail(const PackedBoard *corner, size_t tail, SolverControl *control,
+                       MovePlan *plan) {
+    SolverConfig config = {0};
+    SolverResult result;
+
+    config.control = control;
+    config.engine = SOLVER_ENGINE_BIDIRECTIONAL;
+    config.weight = REDUCE_POLISH_WEIGHT;
+    config.table_states = REDUCE_POLISH_TABLE;
+    config.node_limit = REDUCE_POLISH_NODES;
+    if (!solver_solve_with(corner, &config, &result)) {
+        return result.status != SOLVER_CANCELLED;
+    }
+    if (tail + (size_t)result.length < plan->length) {
+        plan->polished += plan->length - tail - (size_t)result.length;
+        memcpy(plan->moves + tail, result.moves, (size_t)result.length);
+        plan->length = tail + (size_t)result.length;
+    }
+    return 1;
+}
+
+static int lower_bound(const Board *board) {
+    PackedBoard packed;
+    return board_to_packed(board, &packed) ? solver_heuristic(&packed) : board->manhattan;
+}
+
+int reduce_solve(const Board *start, int polish, SolverControl *control, MovePlan *plan) {
+    Reducer r;
+    PackedBoard corner;
+    size_t tail = SIZE_MAX;  // Plan length when the last 4x4 was reached
+    int cells = start->cells;
+    int ok;
+
+    plan->length = 0;
+    plan->polished = 0;
+    plan->lower_bound = lower_bound(start);
+    if (!board_is_solvable(start)) {
+        return 0;
+    }
+
+    memset(&r, 0, sizeof(r));
+    r.plan = plan;
+    r.control = control;
+    r.locked = calloc((size_t)cells, 1);
+    r.queue = malloc((size_t)cells * sizeof(uint16_t));
+    r.from = malloc((size_t)cells * sizeof(int16_t));
+    r.route = malloc((size_t)cells * sizeof(uint16_t));
+    r.index = malloc((size_t)cells * sizeof(int16_t));
+    r.region = malloc((size_t)cells * sizeof(uint16_t));
+    ok = r.locked && r.queue && r.from && r.route && r.index && r.region &&
+         board_copy(&r.board, start);
+
+    for (int k = 0; ok && k < start->size - 3; k++) {
+        if (polish && k == start->size - 4) {
+            tail = plan->length;
+            ok = corner_board(&r.board, 4, &corner);
+        }
+        ok = ok && reduce_square(&r, k);
+    }
+    ok = ok && finish_square(&r) && board_is_solved(&r.board);
+    ok = ok && (tail == SIZE_MAX || polish_tail(&corner, tail, control, plan));
+
+    board_free(&r.board);
+    free(r.locked);
+    free(r.queue);
+    free(r.from);
+    free(r.route);
+    free(r.index);
+    free(r.region);
+    free(r.exact_from);
+    free(r.exact_queue);
+
+    return ok && (!polish || reduce_polish(start, control, plan));
+}
+
+// Polish
+// Each window's end state is a target position per tile; IDA* with the
+// Manhattan distance to those targets looks for a shorter way there
+
+typedef struct {
+    Board board;
+    int *target;    // Cell each tile has to reach
+    uint8_t path[REDUCE_POLISH_WINDOW];
+    int length;
+    int bound;
+} Polisher;
+
+static int polish_search(Polisher *p, int g, int h, int prev_dir) {
+    if (h == 0) {
+        p->length = g;
+        return 1;
+    }
+    if (g + h > p->bound) {
+        return 0;
+    }
+
+    Board *board = &p->board;
+    for (int dir = 0; dir < MOVE_COUNT; dir++) {
+        if (dir == (prev_dir ^ 1)) {
+            continue;
+        }
+        int cell = board_neighbor(board, dir);
+        if (cell < 0) {
+            continue;
+        }
+        int blank = board->empty;
+        int tile = board->tiles[cell];
+        int child_h = h + board_distance(board, blank, p->target[tile]) -
+                      board_distance(board, cell, p->target[tile]);
+
+        board_slide(board, cell);
+        int found = polish_search(p, g + 1, child_h, dir);
+        board_slide(board, blank);
+
+        if (found) {
+            p->path[g] = (uint8_t)dir;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Slide the empty cell one way and follow the tile that moved
+static void apply_move(Board *board, int *where, int dir) {
+    int blank = board->empty;
+    int tile = board_slide(board, board_neighbor(board, dir));
+    where[tile] = blank;
+}
+
+int reduce_polish(const Board *start, SolverControl *control, MovePlan *plan) {
+    Polisher p;
+    int *where = malloc((size_t)start->cells * sizeof(int));  // Cell of each tile
+    int touched[REDUCE_POLISH_WINDOW];
+    size_t before = plan->length;
+    size_t kept = 0;
+
+    // Moves that undo the one before cancel out
+    for (size_t i = 0; i < plan->length; i++) {
+        if (kept > 0 && plan->moves[kept - 1] == (plan->moves[i] ^ 1)) {
+            kept--;
+        } else {
+            plan->moves[kept++] = plan->moves[i];
+        }
+    }
+    plan->length = kept;
+
+    memset(&p, 0, sizeof(p));
+    p.target = malloc((size_t)start->cells * sizeof(int));
+    if (!where || !p.target || !board_copy(&p.board, start)) {
+        free(where);
+        free(p.target);
+        board_free(&p.board);
+        return 0;
+    }
+    for (int cell = 0; cell < start->cells; cell++) {
+        where[start->tiles[cell]] = cell;
+        p.target[start->tiles[cell]] = cell;
+    }
+
+    // Outside a window every tile's target is where it is
+    int ok = 1;
+    for (size_t i = 0; i + REDUCE_POLISH_WINDOW <= plan->length;) {
+        if (control && __atomic_load_n(&control->cancel, __ATOMIC_RELAXED)) {
+            ok = 0;
+            break;
+        }
+
+        // Play the window forward to learn where its tiles end up, then back
+        int count = 0;
+        for (int m = 0; m < REDUCE_POLISH_WINDOW; m++) {
+            int tile = p.board.tiles[board_neighbor(&p.board, plan->moves[i + m])];
+            int seen = 0;
+            for (int t = 0; t < count; t++) {
+                seen |= touched[t] == tile;
+            }
+            if (!seen) {
+                touched[count++] = tile;
+            }
+            apply_move(&p.board, p.target, plan->moves[i + m]);
+        }
+        for (int m = REDUCE_POLISH_WINDOW; m-- > 0;) {
+            board_slide(&p.board, board_neighbor(&p.board, plan->moves[i + m] ^ 1));
+        }
+
+        int h = 0;
+        for (int t = 0; t < count; t++) {
+            h += board_distance(&p.board, where[touched[t]], p.target[touched[t]]);
+        }
+
+        // Bounds keep the window's parity, shared by every path between its ends
+        p.length = -1;
+        for (p.bound = h; p.bound < REDUCE_POLISH_WINDOW; p.bound += 2) {
+            if (polish_search(&p, 0, h, -1)) {
+                break;
+            }
+        }
+        for (int t = 0; t < count; t++) {
+            p.target[touched[t]] = where[touched[t]];
+        }
+
+        if (p.length >= 0) {
+            memcpy(plan->moves + i, p.path, (size_t)p.length);
+            memmove(plan->moves + i + p.length, plan->moves + i + REDUCE_POLISH_WINDOW,
+                    plan->length - i - REDUCE_POLISH_WINDOW);
+            plan->length -= (size_t)(REDUCE_POLISH_WINDOW - p.length);
+            continue;  // Try again from here with the moves that follow
+        }
+        apply_move(&p.board, where, plan->moves[i]);
+        int moved = p.board.tiles[board_neighbor(&p.board, plan->moves[i] ^ 1)];
+        p.target[moved] = where[moved];
+        i++;
+    }
+
+    plan->polished += before - plan->length;
+    free(where);
+    free(p.target);
+    board_free(&p.board);
+    return ok;
+}
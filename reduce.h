@@ -0,0 +1,49 @@
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "board.h"
+#include "solver.h"
+
+// Fast suboptimal solver for boards of any supported size. The top row and
+// left column are placed a tile at a time, which leaves the same problem one
+// size smaller (5x5 to 4x4 to 3x3), and the last 3x3 is solved optimally.
+// Each tile is placed by an exact breadth-first search while the unsolved
+// region is small, and otherwise follows a shortest route of its own with the
+// empty cell walked round in front; the last two tiles of a line are finished
+// together. Milliseconds up to about 16x16; solutions grow as size^3.
+//
+// Polish re-solves the last 4x4 with weighted bidirectional search, then
+// re-searches short windows of the plan for shorter ways between their ends.
+
+// Weighted search over the last 4x4: weight in percent, backward table
+// states and forward nodes before the reduction's own moves are kept
+#define REDUCE_POLISH_WEIGHT 150
+#define REDUCE_POLISH_TABLE 4096
+#define REDUCE_POLISH_NODES (1u << 19)
+
+// Moves in each window the polish pass tries to shorten
+#define REDUCE_POLISH_WINDOW 16
+
+// Solution of any length
+typedef struct {
+    uint8_t *moves;    // MoveDirection values
+    size_t length;
+    size_t capacity;
+    int lower_bound;   // Heuristic distance of the start board; nothing is shorter
+    size_t polished;   // Moves the polish pass removed
+} MovePlan;
+
+void move_plan_free(MovePlan *plan);
+
+// Solve into a plan (reused if it holds one already), polished if asked.
+// Returns 0 for unsolvable boards, when out of memory or once the optional
+// control is cancelled.
+int reduce_solve(const Board *start, int polish, SolverControl *control, MovePlan *plan);
+
+// Drop moves that undo the one before, then re-search every window of
+// REDUCE_POLISH_WINDOW moves for a shorter way between its ends
+int reduce_polish(const Board *start, SolverControl *control, MovePlan *plan);
+
+#endif // REDUCE_H
@@ -7,75 +7,495 @@ void render_background(void) {
     SDL_RenderClear(game.renderer);
 }
 
+// Retained rendering: the composed board lives in a target texture and only
+// cells whose tile changed since they were drawn are re-blitted into it.
+// Frames identical to the one on screen are not presented at all.
+static struct {
+    SDL_Texture *board;             // Composed board
+    SDL_bool unsupported;           // Render targets failed; draw directly
+    int board_size;                 // Board size the texture was built for
+    int *drawn;                     // Tile in each cell, -1 unknown
+    SDL_bool valid;                 // Window shows the last presented frame
+    GameState state;                // Screen last presented
+    SDL_bool hint_shown;            // Overlays last presented
+    int hint_x, hint_y;
+    SDL_bool solving;
+} retained;
+
+// Tiles are drawn in batches: every tile is a quad sampling the atlas (or
+// its white block, tinted, for solid fills) plus four one-pixel border
+// quads and, on plain tiles, one quad per label digit. A batch goes out in a
+// single SDL_RenderGeometry call, or in a few when a large board fills it.
+#define BATCH_MAX_QUADS 4096
+
+typedef struct {
+    SDL_Vertex vertices[BATCH_MAX_QUADS * 4];
+    int indices[BATCH_MAX_QUADS * 6];
+    int quads;
+} TileBatch;
+
+static TileBatch tile_batch;
+
+static void flush_batch(TileBatch *batch) {
+    if (batch->quads > 0) {
+        SDL_RenderGeometry(game.renderer, game.atlas.texture, batch->vertices, batch->quads * 4,
+                           batch->indices, batch->quads * 6);
+        batch->quads = 0;
+    }
+}
+
+static void batch_quad(TileBatch *batch, float x, float y, float w, float h,
+                       const SDL_Rect *source, SDL_Color color) {
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+    if (game.atlas.texture) {
+        u0 = (float)source->x / (float)game.atlas.width;
+        v0 = (float)source->y / (float)game.atlas.height;
+        u1 = (float)(source->x + source->w) / (float)game.atlas.width;
+        v1 = (float)(source->y + source->h) / (float)game.atlas.height;
+    }
+
+    if (batch->quads == BATCH_MAX_QUADS) {
+        flush_batch(batch);
+    }
+
+    // Corners in order top-left, top-right, bottom-left, bottom-right
+    SDL_Vertex *v = &batch->vertices[batch->quads * 4];
+    int *index = &batch->indices[batch->quads * 6];
+    int base = batch->quads * 4;
+    v[0] = (SDL_Vertex){{x, y}, color, {u0, v0}};
+    v[1] = (SDL_Vertex){{x + w, y}, color, {u1, v0}};
+    v[2] = (SDL_Vertex){{x, y + h}, color, {u0, v1}};
+    v[3] = (SDL_Vertex){{x + w, y + h}, color, {u1, v1}};
+    index[0] = base;
+    index[1] = base + 1;
+    index[2] = base + 2;
+    index[3] = base + 2;
+    index[4] = base + 1;
+    index[5] = base + 3;
+    batch->quads++;
+}
+
+// Tile art is used only when every tile of the board has an image, so a
+// board never mixes pictures with drawn labels
+static int have_tile_art(void) {
+    int tiles = game.board_size * game.board_size - 1;
+    if (tiles > ASSET_NUMBER_COUNT) {
+        return 0;
+    }
+    for (int i = 0; i < tiles; i++) {
+        if (game.atlas.numbers[i].w == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Width of a number in the digit glyphs, one glyph pixel between digits
+static float number_width(int value, float scale) {
+    char text[12];
+    int length = snprintf(text, sizeof(text), "%d", value);
+    return ((float)(game.atlas.digits[0].w + 1) * (float)length - 1.0f) * scale;
+}
+
+// Number drawn from the digit glyphs with its top-left corner at (x, y);
+// scale is whole pixels per glyph pixel, so the font stays crisp
+static void batch_number(TileBatch *batch, float x, float y, float scale, int value,
+                         SDL_Color color) {
+    char text[12];
+    int length = snprintf(text, sizeof(text), "%d", value);
+    const SDL_Rect *glyph = &game.atlas.digits[0];
+    float w = (float)glyph->w * scale, h = (float)glyph->h * scale;
+
+    if (glyph->w == 0) {
+        return;
+    }
+    for (int i = 0; i < length; i++) {
+        batch_quad(batch, (float)(int)(x + (float)i * (w + scale)), (float)(int)y, w, h,
+                   &game.atlas.digits[text[i] - '0'], color);
+    }
+}
+
+// Tile number centred on the tile, about a quarter of its height
+static void batch_label(TileBatch *batch, float x, float y, float size, int value) {
+    float glyph_h = (float)game.atlas.digits[0].h;
+    float scale = (float)(int)(size / (glyph_h * 4.0f));
+    if (scale < 1.0f) {
+        if (size < glyph_h + 2.0f) {
+            return;  // Too small to read
+        }
+        scale = 1.0f;
+    }
+    batch_number(batch, x + (size - number_width(value, scale)) / 2.0f,
+                 y + (size - glyph_h * scale) / 2.0f, scale, value, (SDL_Color)COLOR_TEXT);
+}
+
+// Tile at a sub-pixel position, so sliding tiles move smoothly
+static void batch_tile(TileBatch *batch, float x, float y, float size, int value) {
+    // Sample the middle of the white block so filtering never reaches its edge
+    SDL_Rect white = {game.atlas.white.x + 1, game.atlas.white.y + 1,
+                      game.atlas.white.w - 2, game.atlas.white.h - 2};
+    SDL_Color tint = {255, 255, 255, 255};
+
+    if (value == 0) {
+        // Empty tile
+        batch_quad(batch, x, y, size, size, &white, (SDL_Color)COLOR_EMPTY);
+    } else if (have_tile_art()) {
+        // Number tile
+        batch_quad(batch, x, y, size, size, &game.atlas.numbers[value - 1], tint);
+    } else {
+        // Colored rectangle with a drawn label
+        batch_quad(batch, x, y, size, size, &white, (SDL_Color)COLOR_TILE);
+        batch_label(batch, x, y, size, value);
+    }
+
+    // Border
+    SDL_Color border = COLOR_BORDER;
+    batch_quad(batch, x, y, size, 1, &white, border);
+    batch_quad(batch, x, y + size - 1, size, 1, &white, border);
+    batch_quad(batch, x, y, 1, size, &white, border);
+    batch_quad(batch, x + size - 1, y, 1, size, &white, border);
+}
+
 void render_tile(int x, int y, int value) {
     int tile_size = get_tile_size();
     int screen_x, screen_y;
     board_to_screen_coords(x, y, &screen_x, &screen_y);
     
-    SDL_Rect rect = {screen_x, screen_y, tile_size, tile_size};
-    
-    if (value == 0) {
-        // Empty tile
-        SDL_Color empty = COLOR_EMPTY;
-        SDL_SetRenderDrawColor(game.renderer, empty.r, empty.g, empty.b, empty.a);
-        SDL_RenderFillRect(game.renderer, &rect);
-    } else {
-        // Number tile
-        if (value <= MAX_TEXTURES && game.number_textures[value - 1]) {
-            SDL_RenderCopy(game.renderer, game.number_textures[value - 1], NULL, &rect);
-        } else {
-            // Fallback: colored rectangle
-            SDL_Color tile = COLOR_TILE;
-            SDL_SetRenderDrawColor(game.renderer, tile.r, tile.g, tile.b, tile.a);
-            SDL_RenderFillRect(game.renderer, &rect);
+    batch_tile(&tile_batch, (float)screen_x, (float)screen_y, (float)tile_size, value);
+    flush_batch(&tile_batch);
+}
+
+// Tile shown in a cell: the settled display, with the sliding tile lifted out
+static int shown_tile(int x, int y) {
+    if (game.slide_count > 0) {
+        const Slide *slide = &game.slides[game.slide_first];
+        if (x == slide->from_x && y == slide->from_y) {
+            return 0;
         }
     }
-    
-    // Draw border
-    SDL_Color border = COLOR_BORDER;
-    SDL_SetRenderDrawColor(game.renderer, border.r, border.g, border.b, border.a);
-    SDL_RenderDrawRect(game.renderer, &rect);
+    return game.display.tiles[y * game.board_size + x];
 }
 
-void render_game(void) {
-    render_background();
-    
-    // Render all tiles
+// Force the next frame to be presented (window exposed, screen changed)
+void invalidate_render(void) {
+    retained.valid = SDL_FALSE;
+}
+
+// Drop the board texture; it is rebuilt from scratch on the next frame
+void free_render_cache(void) {
+    if (retained.board) {
+        SDL_DestroyTexture(retained.board);
+        retained.board = NULL;
+    }
+    free(retained.drawn);
+    retained.drawn = NULL;
+    retained.board_size = 0;
+    retained.valid = SDL_FALSE;
+}
+
+// Bring the board texture up to date; returns the number of cells redrawn,
+// or -1 when render targets are unavailable
+static int update_board_texture(void) {
+    int tile_size = get_tile_size();
+    int redrawn = 0;
+
+    if (retained.unsupported) {
+        return -1;
+    }
+    if (!retained.board || retained.board_size != game.board_size) {
+        free_render_cache();
+        size_t cells = (size_t)game.board_size * game.board_size;
+        retained.board = SDL_CreateTexture(game.renderer, SDL_PIXELFORMAT_RGBA32,
+                                           SDL_TEXTUREACCESS_TARGET,
+                                           tile_size * game.board_size,
+                                           tile_size * game.board_size);
+        retained.drawn = malloc(cells * sizeof(*retained.drawn));
+        if (!retained.board || !retained.drawn) {
+            free_render_cache();
+            retained.unsupported = SDL_TRUE;
+            return -1;
+        }
+        retained.board_size = game.board_size;
+        memset(retained.drawn, -1, cells * sizeof(*retained.drawn));
+    }
+
     for (int y = 0; y < game.board_size; y++) {
         for (int x = 0; x < game.board_size; x++) {
-            render_tile(x, y, game.board[x][y]);
+            int value = shown_tile(x, y);
+            int *drawn = &retained.drawn[y * game.board_size + x];
+            if (*drawn == value) {
+                continue;
+            }
+            if (redrawn == 0 && SDL_SetRenderTarget(game.renderer, retained.board) != 0) {
+                free_render_cache();
+                retained.unsupported = SDL_TRUE;
+                return -1;
+            }
+            batch_tile(&tile_batch, (float)(x * tile_size), (float)(y * tile_size),
+                       (float)tile_size, value);
+            *drawn = value;
+            redrawn++;
         }
     }
+    if (redrawn > 0) {
+        flush_batch(&tile_batch);
+        SDL_SetRenderTarget(game.renderer, NULL);
+    }
+    return redrawn;
+}
+
+#if TAQUIN_PROFILE
+// F3 overlay, refreshed every PROFILE_OVERLAY_MS: frame times over the last
+// interval as a histogram on a linear axis, p50 (white) and p99 (orange)
+// marked on it and written beside it in microseconds, and under them the
+// p99 from input to the frame that showed it (blue), over the whole run
+#define PROFILE_OVERLAY_MS 500
+#define PROFILE_CHART_WIDTH 160
+#define PROFILE_CHART_HEIGHT 60
+
+static struct {
+    ProfileHistogram seen;   // Frame totals at the last refresh
+    ProfileHistogram frame;  // Frames of the interval shown
+    ProfileHistogram input;
+    Uint32 refreshed;
+} overlay;
+
+// Take the samples since the last refresh; returns 1 when the figures change
+static int refresh_overlay(void) {
+    static ProfileHistogram now;
+
+    if (overlay.refreshed && SDL_GetTicks() - overlay.refreshed < PROFILE_OVERLAY_MS) {
+        return 0;
+    }
+    overlay.refreshed = SDL_GetTicks();
+    profile_snapshot(PROFILE_FRAME, &now);
+    overlay.frame = now;
+    profile_subtract(&overlay.frame, &overlay.seen);
+    overlay.seen = now;
+    profile_snapshot(PROFILE_INPUT, &overlay.input);
+    return 1;
+}
+
+static void render_profile_overlay(void) {
+    SDL_Color panel = COLOR_PROFILE_PANEL;
+    SDL_Color colors[3] = {COLOR_PROFILE_P50, COLOR_PROFILE_P99, COLOR_PROFILE_INPUT};
+    SDL_Rect white = {game.atlas.white.x + 1, game.atlas.white.y + 1,
+                      game.atlas.white.w - 2, game.atlas.white.h - 2};
+    const ProfileHistogram *frame = &overlay.frame;
+    double us_per_tick = profile_ns_per_tick() / 1000.0;
+    float scale = 2.0f;
+    float row = (float)game.atlas.digits[0].h * scale + 6.0f;
+    float x = 16.0f, y = 16.0f;
+
+    if (!game.show_profile) {
+        return;
+    }
+    SDL_Rect back = {8, 8, PROFILE_CHART_WIDTH + 110, PROFILE_CHART_HEIGHT + 16};
+    if (back.h < (int)(row * 3.0f) + 16) {
+        back.h = (int)(row * 3.0f) + 16;
+    }
+    SDL_SetRenderDrawBlendMode(game.renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(game.renderer, panel.r, panel.g, panel.b, panel.a);
+    SDL_RenderFillRect(game.renderer, &back);
+
+    // Axis from 0 to twice the p99, so outliers pile up at the right edge
+    uint64_t marks[2] = {profile_percentile(frame, 0.50), profile_percentile(frame, 0.99)};
+    double axis = marks[1] > 0 ? (double)marks[1] * 2.0 : 1.0;
+    uint64_t tallest = 1;
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        tallest = frame->buckets[i] > tallest ? frame->buckets[i] : tallest;
+    }
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        if (frame->buckets[i] == 0) {
+            continue;
+        }
+        uint64_t width;
+        double low = (double)profile_bucket_low(i, &width);
+        float left = (float)(low / axis * PROFILE_CHART_WIDTH);
+        float w = (float)((double)width / axis * PROFILE_CHART_WIDTH);
+        float h = (float)frame->buckets[i] / (float)tallest * PROFILE_CHART_HEIGHT;
+        left = left > PROFILE_CHART_WIDTH - 1 ? PROFILE_CHART_WIDTH - 1 : left;
+        w = w < 1.0f ? 1.0f : w;
+        batch_quad(&tile_batch, x + left, y + PROFILE_CHART_HEIGHT - h, w, h, &white,
+                   (SDL_Color)COLOR_PROFILE_BARS);
+    }
+    for (int m = 0; m < 2; m++) {
+        float at = (float)((double)marks[m] / axis * PROFILE_CHART_WIDTH);
+        batch_quad(&tile_batch, x + at, y, 1.0f, PROFILE_CHART_HEIGHT, &white, colors[m]);
+    }
+
+    // p50 and p99 frame time, then p99 input latency
+    uint64_t figures[3] = {marks[0], marks[1], profile_percentile(&overlay.input, 0.99)};
+    for (int f = 0; f < 3; f++) {
+        batch_number(&tile_batch, x + PROFILE_CHART_WIDTH + 12.0f, y + row * (float)f, scale,
+                     (int)((double)figures[f] * us_per_tick + 0.5), colors[f]);
+    }
+    flush_batch(&tile_batch);
+}
+#else
+static void render_profile_overlay(void) {
+}
+#endif // TAQUIN_PROFILE
+
+// Record what is about to be presented; returns 0 if it is already on screen
+static int frame_changed(SDL_bool board_changed) {
+    SDL_bool hint_moved = game.hint_shown &&
+                          (game.hint_x != retained.hint_x || game.hint_y != retained.hint_y);
+#if TAQUIN_PROFILE
+    int overlay_changed = game.show_profile && refresh_overlay();
+#else
+    int overlay_changed = 0;
+#endif
+    int changed = !retained.valid || board_changed || retained.state != game.state || overlay_changed ||
+                  retained.hint_shown != game.hint_shown || hint_moved ||
+                  game.solving || retained.solving || game.is_animating;
+
+    retained.valid = SDL_TRUE;
+    retained.state = game.state;
+    retained.hint_shown = game.hint_shown;
+    retained.hint_x = game.hint_x;
+    retained.hint_y = game.hint_y;
+    retained.solving = game.solving;
+    return changed;
+}
+
+static double ease(double t) {
+    switch (ANIMATION_EASING) {
+        case EASE_LINEAR:
+            return t;
+        case EASE_IN_OUT_CUBIC:
+            return t < 0.5 ? 4.0 * t * t * t : 1.0 - 4.0 * (1.0 - t) * (1.0 - t) * (1.0 - t);
+        default: {
+            double u = 1.0 - t;
+            return 1.0 - u * u * u;
+        }
+    }
+}
+
+// The moving tile, placed from the real time since its slide began
+static void render_sliding_tile(void) {
+    if (game.slide_count == 0) {
+        return;
+    }
+
+    const Slide *slide = &game.slides[game.slide_first];
+    Uint64 elapsed = SDL_GetPerformanceCounter() - game.slide_start;
+    double t = elapsed >= game.slide_ticks ? 1.0 : (double)elapsed / (double)game.slide_ticks;
+    double k = ease(t);
+    int from_x, from_y, to_x, to_y;
+    board_to_screen_coords(slide->from_x, slide->from_y, &from_x, &from_y);
+    board_to_screen_coords(slide->to_x, slide->to_y, &to_x, &to_y);
+
+    batch_tile(&tile_batch, (float)(from_x + (to_x - from_x) * k),
+               (float)(from_y + (to_y - from_y) * k), (float)get_tile_size(), slide->tile);
+    flush_batch(&tile_batch);
+}
+
+void render_game(void) {
+    int redrawn = update_board_texture();
+
+    if (!frame_changed(redrawn != 0)) {
+        return;
+    }
+    render_background();
+
+    if (redrawn >= 0) {
+        int x, y;
+        board_to_screen_coords(0, 0, &x, &y);
+        SDL_Rect rect = {x, y, get_tile_size() * game.board_size, get_tile_size() * game.board_size};
+        SDL_RenderCopy(game.renderer, retained.board, NULL, &rect);
+    } else {
+        // No render targets: draw every tile directly, still in one batch
+        int tile_size = get_tile_size();
+        for (int y = 0; y < game.board_size; y++) {
+            for (int x = 0; x < game.board_size; x++) {
+                int screen_x, screen_y;
+                board_to_screen_coords(x, y, &screen_x, &screen_y);
+                batch_tile(&tile_batch, (float)screen_x, (float)screen_y, (float)tile_size,
+                           shown_tile(x, y));
+            }
+        }
+        flush_batch(&tile_batch);
+    }
+    render_sliding_tile();
     
     render_ui_elements();
+    render_profile_overlay();
     SDL_RenderPresent(game.renderer);
 }
 
 void render_menu(void) {
+    if (!frame_changed(SDL_FALSE)) {
+        return;
+    }
     render_background();
     
     // Render menu background if available
-    if (game.ui_textures[0]) {
-        SDL_RenderCopy(game.renderer, game.ui_textures[0], NULL, NULL);
+    if (game.atlas.ui[0].w > 0) {
+        SDL_RenderCopy(game.renderer, game.atlas.texture, &game.atlas.ui[0], NULL);
     }
+    render_profile_overlay();
     
     SDL_RenderPresent(game.renderer);
 }
 
 void render_win_screen(void) {
+    if (!frame_changed(SDL_FALSE)) {
+        return;
+    }
     render_background();
     
     // Render win screen if available
-    if (game.ui_textures[4]) {
-        SDL_RenderCopy(game.renderer, game.ui_textures[4], NULL, NULL);
+    if (game.atlas.ui[4].w > 0) {
+        SDL_RenderCopy(game.renderer, game.atlas.texture, &game.atlas.ui[4], NULL);
     }
+    render_profile_overlay();
     
     SDL_RenderPresent(game.renderer);
 }
 
 void render_ui_elements(void) {
-    // This function can be expanded to render score, timer, etc.
-    // For now, it's a placeholder for future UI elements
+    int tile_size = get_tile_size();
+    int board_x, board_y;
+    board_to_screen_coords(0, 0, &board_x, &board_y);
+
+    // Hint: outline the tile to slide next
+    if (game.hint_shown) {
+        SDL_Color hint = COLOR_HINT;
+        int x, y;
+        board_to_screen_coords(game.hint_x, game.hint_y, &x, &y);
+        SDL_SetRenderDrawColor(game.renderer, hint.r, hint.g, hint.b, hint.a);
+        for (int i = 0; i < 4; i++) {
+            SDL_Rect outline = {x + i, y + i, tile_size - 2 * i, tile_size - 2 * i};
+            SDL_RenderDrawRect(game.renderer, &outline);
+        }
+    }
+
+    // Distance to the goal above the board: tiles out of place on the left,
+    // their summed Manhattan distance on the right
+    if (game.scores.settings.show_distance) {
+        float scale = 2.0f;
+        float top = (float)board_y - (float)game.atlas.digits[0].h * scale - 8.0f;
+        float width = (float)(tile_size * game.board_size);
+        batch_number(&tile_batch, (float)board_x, top, scale, game.board.misplaced,
+                     (SDL_Color)COLOR_TEXT);
+        batch_number(&tile_batch, (float)board_x + width - number_width(game.board.manhattan, scale),
+                     top, scale, game.board.manhattan, (SDL_Color)COLOR_TEXT);
+        flush_batch(&tile_batch);
+    }
+
+    // Search running: a segment sweeping along a bar under the board
+    if (game.solving) {
+        SDL_Color progress = COLOR_PROGRESS;
+        int width = tile_size * game.board_size;
+        int segment = width / 4;
+        int offset = (int)(SDL_GetTicks() / 4 % (Uint32)(width + segment)) - segment;
+        int left = offset < 0 ? 0 : offset;
+        int right = offset + segment > width ? width : offset + segment;
+        SDL_Rect bar = {board_x + left, board_y + width + 10, right - left, 6};
+        SDL_SetRenderDrawColor(game.renderer, progress.r, progress.g, progress.b, progress.a);
+        SDL_RenderFillRect(game.renderer, &bar);
+    }
 }
 
 // Utility functions
@@ -103,37 +523,72 @@ void board_to_screen_coords(int board_x, int board_y, int *screen_x, int *screen
 }
 
 void get_empty_position(int *x, int *y) {
-    *x = game.empty_x;
-    *y = game.empty_y;
+    *x = game.board.empty % game.board_size;
+    *y = game.board.empty / game.board_size;
 }
 
 // Animation functions
+// A move updates game.board at once and queues a slide; game.display
+// catches up one slide at a time. Slides run on real time rather than
+// frames or steps, and a backlog plays faster so the display never lags
+// far behind the clicks.
+static Uint64 slide_duration(void) {
+    int backlog = game.slide_count < 1 ? 1 : game.slide_count < 4 ? game.slide_count : 4;
+    return SDL_GetPerformanceFrequency() * ANIMATION_MS / 1000 / (Uint64)backlog;
+}
+
+// Show the board as it is, dropping any slides still queued
+void sync_display(void) {
+    if (!board_copy(&game.display, &game.board)) {
+        SDL_ExitWithError("Failed to allocate the board");
+    }
+    game.slide_first = 0;
+    game.slide_count = 0;
+    game.is_animating = SDL_FALSE;
+}
+
 void start_tile_animation(int from_x, int from_y, int to_x, int to_y, int tile_value) {
+    if (game.slide_count == ANIMATION_QUEUE) {
+        sync_display();  // Hopelessly behind: jump to the current board
+        return;
+    }
+
+    Slide *slide = &game.slides[(game.slide_first + game.slide_count) % ANIMATION_QUEUE];
+    *slide = (Slide){tile_value, from_x, from_y, to_x, to_y};
+    if (game.slide_count++ == 0) {
+        game.slide_start = SDL_GetPerformanceCounter();
+        game.slide_ticks = slide_duration();
+    }
     game.is_animating = SDL_TRUE;
-    game.animation_progress = 0;
-    game.animation_start_x = from_x;
-    game.animation_start_y = from_y;
-    game.animation_end_x = to_x;
-    game.animation_end_y = to_y;
-    game.animation_tile = tile_value;
 }
 
+// Settle finished slides; each next one starts when the previous ended,
+// not at this frame, so queued slides keep an even pace
 void update_animations(void) {
-    if (!game.is_animating) {
-        return;
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    while (game.slide_count > 0 && now - game.slide_start >= game.slide_ticks) {
+        const Slide *slide = &game.slides[game.slide_first];
+        board_slide(&game.display, slide->from_y * game.board_size + slide->from_x);
+        game.slide_first = (game.slide_first + 1) % ANIMATION_QUEUE;
+        game.slide_count--;
+        game.slide_start += game.slide_ticks;
+        game.slide_ticks = slide_duration();
     }
-    
-    game.animation_progress += ANIMATION_SPEED;
-    
-    if (game.animation_progress >= 100) {
+    if (game.slide_count == 0) {
         game.is_animating = SDL_FALSE;
-        game.animation_progress = 0;
+        if (game.win_pending) {
+            game.win_pending = SDL_FALSE;
+            game.state = GAME_STATE_WIN;
+        }
     }
 }
 
 // Input handling
 void handle_mouse_click(int mouse_x, int mouse_y) {
-    if (game.state != GAME_STATE_PLAYING || game.is_animating) {
+    // Clicks during a slide are queued behind it; none once solved or
+    // while a logged game plays back
+    if (game.state != GAME_STATE_PLAYING || game.win_pending || game.replaying) {
         return;
     }
     
@@ -144,9 +599,11 @@ void handle_mouse_click(int mouse_x, int mouse_y) {
         board_y >= 0 && board_y < game.board_size) {
         
         if (make_move(board_x, board_y)) {
+            clear_assist();
             if (check_win_condition()) {
-                game.state = GAME_STATE_WIN;
+                game.win_pending = SDL_TRUE;
                 save_best_score();
+                finish_recording(SDL_TRUE);
             }
         }
     }
@@ -163,6 +620,8 @@ void handle_game_input(SDL_Event *event) {
         case SDL_KEYDOWN:
             switch (event->key.keysym.sym) {
                 case SDLK_ESCAPE:
+                    clear_assist();
+                    finish_recording(SDL_FALSE);
                     game.state = GAME_STATE_MENU;
                     break;
                 case SDLK_r:
@@ -170,7 +629,24 @@ void handle_game_input(SDL_Event *event) {
                     break;
                 case SDLK_n:
                     shuffle_board();
-                    game.stats.moves = 0;
+                    break;
+                case SDLK_h:
+                    if (!game.hint_shown && !game.solving && !game.autoplay && !game.replaying) {
+                        start_solve(SOLVE_HINT);
+                    }
+                    break;
+                case SDLK_d:
+                    game.scores.settings.show_distance = !game.scores.settings.show_distance;
+                    invalidate_render();
+                    save_settings();
+                    break;
+                case SDLK_a:
+                    // Toggles: a second press stops the search or playback
+                    if (game.autoplay || game.solving || game.replaying) {
+                        clear_assist();
+                    } else {
+                        start_solve(SOLVE_AUTO);
+                    }
                     break;
             }
             break;
@@ -190,43 +666,153 @@ void handle_menu_input(SDL_Event *event) {
                 case SDLK_5:
                     reset_game(5);
                     break;
+                case SDLK_6:
+                case SDLK_7:
+                case SDLK_8:
+                case SDLK_9:
+                    // Beyond 5x5 tiles are drawn with labels
+                    reset_game(event->key.keysym.sym - SDLK_0);
+                    break;
+                case SDLK_p:
+                    start_replay(UINT64_MAX);  // Latest game in the log
+                    break;
+                case SDLK_RETURN:
+                case SDLK_SPACE:
+                    reset_game((int)game.scores.settings.board_size);  // Last size played
+                    break;
                 case SDLK_ESCAPE:
-                case SDLK_q:
-                    exit(0);
+                case SDLK_q: {
+                    // Through the main loop, so cleanup writes out the move log
+                    SDL_Event quit = {.type = SDL_QUIT};
+                    SDL_PushEvent(&quit);
                     break;
+                }
             }
             break;
     }
 }
 
-// Statistics and settings (placeholder implementations)
-void update_stats(void) {
-    // Update game timer and other stats
-    // This would be called in the main game loop
+// Statistics and settings
+// Best scores and settings live in one file in the user's preferences
+// directory. Saves never touch the disk on the main thread: the state is
+// copied for a saver thread, which writes the latest copy it was handed,
+// so saves requested while one is running collapse into one.
+static struct {
+    char path[1024];
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *wake;
+    ScoreFile snapshot;  // Guarded by lock
+    SDL_bool dirty;
+    SDL_bool quit;
+} saver;
+
+static int save_thread(void *data) {
+    static ScoreFile copy;
+
+    (void)data;
+    SDL_LockMutex(saver.lock);
+    for (;;) {
+        while (!saver.dirty && !saver.quit) {
+            SDL_CondWait(saver.wake, saver.lock);
+        }
+        if (!saver.dirty) {
+            break;
+        }
+        copy = saver.snapshot;
+        saver.dirty = SDL_FALSE;
+        SDL_UnlockMutex(saver.lock);
+
+        if (!scores_save(&copy, saver.path)) {
+            fprintf(stderr, "Failed to save %s\n", saver.path);
+        }
+        SDL_LockMutex(saver.lock);
+    }
+    SDL_UnlockMutex(saver.lock);
+    return 0;
 }
 
 void save_best_score(void) {
     int size = game.board_size;
-    if (game.stats.best_moves[size] == -1 || game.stats.moves < game.stats.best_moves[size]) {
-        game.stats.best_moves[size] = game.stats.moves;
+
+    // Games won with a hint or auto-solve are logged but not ranked
+    if (game.record.flags & MOVELOG_ASSISTED) {
+        return;
     }
-    
-    if (game.stats.best_time[size] == -1 || game.stats.time_seconds < game.stats.best_time[size]) {
-        game.stats.best_time[size] = game.stats.time_seconds;
+    ScoreEntry entry = {(uint32_t)game.stats.moves,
+                        (uint32_t)(game.stats.play_ticks * 1000 / SDL_GetPerformanceFrequency()),
+                        game.board_seed, (int64_t)time(NULL)};
+
+    int rank = scores_add(&game.scores, size, &entry);
+    if (rank > 0) {
+        const Leaderboard *board = &game.scores.by_moves[size];
+        printf("#%d of the best %dx%d games:\n", rank, size, size);
+        for (uint32_t i = 0; i < board->count; i++) {
+            printf("  %2u. %5u moves %8.1f s\n", i + 1, board->entries[i].moves,
+                   board->entries[i].time_ms / 1000.0);
+        }
     }
-    
+    load_best_scores();
     save_settings();
 }
 
+// Bests for the stats come from the top of each leaderboard
 void load_best_scores(void) {
-    // Load from file - placeholder implementation
-    // In a full implementation, this would read from a save file
+    for (int size = 0; size <= MAX_BOARD_SIZE; size++) {
+        const Leaderboard *fewest = &game.scores.by_moves[size];
+        const Leaderboard *fastest = &game.scores.by_time[size];
+        game.stats.best_moves[size] = fewest->count ? (int)fewest->entries[0].moves : -1;
+        game.stats.best_time[size] = fastest->count ? (int)(fastest->entries[0].time_ms / 1000) : -1;
+    }
 }
 
 void load_settings(void) {
-    // Load settings from file - placeholder implementation
+    char *dir = SDL_GetPrefPath("Taquin", "taquin");
+    snprintf(saver.path, sizeof(saver.path), "%s%s", dir ? dir : "data/", SCORES_FILE);
+    SDL_free(dir);
+
+    if (scores_load(&game.scores, saver.path)) {
+        printf("Loaded scores from %s\n", saver.path);
+    }
+
+    // Without a thread, saves fall back to the main thread
+    saver.lock = SDL_CreateMutex();
+    saver.wake = SDL_CreateCond();
+    if (saver.lock && saver.wake) {
+        saver.thread = SDL_CreateThread(save_thread, "save", NULL);
+    }
 }
 
 void save_settings(void) {
-    // Save settings to file - placeholder implementation
+    if (!saver.thread) {
+        if (saver.path[0] && !scores_save(&game.scores, saver.path)) {
+            fprintf(stderr, "Failed to save %s\n", saver.path);
+        }
+        return;
+    }
+    SDL_LockMutex(saver.lock);
+    saver.snapshot = game.scores;
+    saver.dirty = SDL_TRUE;
+    SDL_CondSignal(saver.wake);
+    SDL_UnlockMutex(saver.lock);
+}
+
+// Let the saver write what it was last handed, then stop it
+void stop_saving(void) {
+    if (saver.thread) {
+        SDL_LockMutex(saver.lock);
+        saver.quit = SDL_TRUE;
+        SDL_CondSignal(saver.wake);
+        SDL_UnlockMutex(saver.lock);
+        SDL_WaitThread(saver.thread, NULL);
+        saver.thread = NULL;
+    }
+    if (saver.wake) {
+        SDL_DestroyCond(saver.wake);
+        saver.wake = NULL;
+    }
+    if (saver.lock) {
+        SDL_DestroyMutex(saver.lock);
+        saver.lock = NULL;
+    }
 }
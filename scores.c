@@ -0,0 +1,122 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "pdb.h"
+#include "scores.h"
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+static const char scores_magic[8] = {'T', 'Q', 'S', 'C', 'O', 'R', 'E', 0};
+
+static uint64_t scores_checksum(const ScoreFile *scores) {
+    return pdb_checksum(scores, offsetof(ScoreFile, checksum), 0);
+}
+
+void scores_init(ScoreFile *scores) {
+    memset(scores, 0, sizeof(*scores));
+    memcpy(scores->magic, scores_magic, sizeof(scores_magic));
+    scores->version = SCORES_VERSION;
+    scores->settings.board_size = 4;
+    scores->settings.show_distance = 1;
+}
+
+int scores_load(ScoreFile *scores, const char *path) {
+    FILE *file = fopen(path, "rb");
+
+    scores_init(scores);
+    if (!file) {
+        return 0;
+    }
+    int ok = fread(scores, sizeof(*scores), 1, file) == 1 &&
+             memcmp(scores->magic, scores_magic, sizeof(scores_magic)) == 0 &&
+             scores->version == SCORES_VERSION &&
+             scores->checksum == scores_checksum(scores);
+    fclose(file);
+
+    // Never trust counts or sizes from a file that did not check out
+    for (int size = 0; ok && size <= BOARD_MAX_SIZE; size++) {
+        ok = scores->by_moves[size].count <= SCORES_TOP && scores->by_time[size].count <= SCORES_TOP;
+    }
+    ok = ok && scores->settings.board_size >= BOARD_MIN_SIZE &&
+         scores->settings.board_size <= BOARD_MAX_SIZE;
+    if (!ok) {
+        scores_init(scores);
+    }
+    return ok;
+}
+
+int scores_save(const ScoreFile *scores, const char *path) {
+    ScoreFile out = *scores;
+    char temp_path[1024];
+
+    out.checksum = scores_checksum(&out);
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE *file = fopen(temp_path, "wb");
+    if (!file) {
+        return 0;
+    }
+
+    // On disk before the rename, or a crash could leave an empty file behind it
+    int ok = fwrite(&out, sizeof(out), 1, file) == 1 && fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok) {
+#ifdef _WIN32
+        remove(path);
+#endif
+        ok = rename(temp_path, path) == 0;
+    }
+    if (!ok) {
+        remove(temp_path);
+    }
+    return ok;
+}
+
+// Insert in order; returns the 1-based rank, or 0 if the board is full of
+// better entries
+static int insert(Leaderboard *board, const ScoreEntry *entry, int by_time) {
+    int rank = (int)board->count;
+
+    while (rank > 0) {
+        const ScoreEntry *above = &board->entries[rank - 1];
+        int better = by_time ? entry->time_ms < above->time_ms ||
+                                   (entry->time_ms == above->time_ms && entry->moves < above->moves)
+                             : entry->moves < above->moves ||
+                                   (entry->moves == above->moves && entry->time_ms < above->time_ms);
+        if (!better) {
+            break;
+        }
+        rank--;
+    }
+    if (rank >= SCORES_TOP) {
+        return 0;
+    }
+
+    int last = board->count < SCORES_TOP ? (int)board->count : SCORES_TOP - 1;
+    memmove(&board->entries[rank + 1], &board->entries[rank],
+            (size_t)(last - rank) * sizeof(ScoreEntry));
+    board->entries[rank] = *entry;
+    if (board->count < SCORES_TOP) {
+        board->count++;
+    }
+    return rank + 1;
+}
+
+int scores_add(ScoreFile *scores, int size, const ScoreEntry *entry) {
+    if (size < BOARD_MIN_SIZE || size > BOARD_MAX_SIZE) {
+        return 0;
+    }
+    insert(&scores->by_time[size], entry, 1);
+    return insert(&scores->by_moves[size], entry, 0);
+}
@@ -0,0 +1,57 @@
+#ifndef SCORES_H
+#define SCORES_H
+
+#include <stdint.h>
+#include "board.h"
+
+// High scores and settings, kept in one small fixed-layout file that is
+// replaced whole on every save: written beside the target, flushed to disk
+// and renamed over it, so a crash leaves either the old file or the new one
+#define SCORES_VERSION 1
+#define SCORES_TOP 10   // Entries per leaderboard
+
+// One solved game
+typedef struct {
+    uint32_t moves;
+    uint32_t time_ms;
+    uint64_t seed;    // Board seed, to find the game in the move log
+    int64_t date;     // Seconds since the epoch
+} ScoreEntry;
+
+// Best games first; ties keep the earlier game ahead
+typedef struct {
+    uint32_t count;
+    uint32_t reserved;
+    ScoreEntry entries[SCORES_TOP];
+} Leaderboard;
+
+typedef struct {
+    uint32_t board_size;     // Last size played, started again from the menu
+    uint32_t show_distance;  // Distance readout above the board
+    uint32_t reserved[6];
+} Settings;
+
+// On-disk layout (little-endian), checksum over everything before it
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    Settings settings;
+    Leaderboard by_moves[BOARD_MAX_SIZE + 1];  // Indexed by board size
+    Leaderboard by_time[BOARD_MAX_SIZE + 1];
+    uint64_t checksum;
+} ScoreFile;
+
+// Defaults: empty leaderboards, 4x4, readout shown
+void scores_init(ScoreFile *scores);
+
+// Returns 0, leaving the defaults, when the file is missing, from another
+// version or damaged
+int scores_load(ScoreFile *scores, const char *path);
+int scores_save(const ScoreFile *scores, const char *path);
+
+// Enter a solved game on both leaderboards of its size; returns its rank by
+// moves (1 is best), or 0 if it did not make that board
+int scores_add(ScoreFile *scores, int size, const ScoreEntry *entry);
+
+#endif // SCORES_H
@@ -0,0 +1,1122 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "heuristic.h"
+#include "solver.h"
+
+// Nodes between progress reports and cancellation checks (power of two)
+#define CONTROL_INTERVAL 4096
+
+// Zobrist keys shared by every search: [tile][cell], the empty cell keyless
+static uint64_t zobrist[PACKED_MAX_CELLS][PACKED_MAX_CELLS];
+static pthread_once_t zobrist_once = PTHREAD_ONCE_INIT;
+
+static uint64_t mix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void zobrist_build(void) {
+    uint64_t seed = 0x74617175696E;
+    for (int tile = 1; tile < PACKED_MAX_CELLS; tile++) {
+        for (int cell = 0; cell < PACKED_MAX_CELLS; cell++) {
+            zobrist[tile][cell] = mix64(&seed);
+        }
+    }
+}
+
+static uint64_t zobrist_key(const PackedBoard *pb) {
+    uint64_t key = 0;
+
+    pthread_once(&zobrist_once, zobrist_build);
+    for (int cell = 0; cell < pb->size * pb->size; cell++) {
+        key ^= zobrist[packed_get(pb, cell)][cell];
+    }
+    return key;
+}
+
+// IDA* only consults the transposition table with at least this much room
+// left under the bound (bound - f); with less, subtrees are cheaper to
+// search again than to look up
+#define TT_MIN_SLACK 2
+
+// Search state for one solve; lives on the caller's stack so the search
+// itself never allocates
+typedef struct {
+    int size;
+    int cells;
+    uint8_t tiles[PACKED_MAX_CELLS];
+    int blank;
+
+    // Precomputed per-size tables
+    uint8_t cell_x[PACKED_MAX_CELLS];
+    uint8_t cell_y[PACKED_MAX_CELLS];
+    uint8_t md[PACKED_MAX_CELLS][PACKED_MAX_CELLS];  // md[tile][cell]
+    int8_t neighbors[PACKED_MAX_CELLS][MOVE_COUNT];
+    uint8_t row_code[PACKED_MAX_CELLS][PACKED_MAX_SIZE];
+    uint8_t col_code[PACKED_MAX_CELLS][PACKED_MAX_SIZE];
+    int place[PACKED_MAX_SIZE];
+    uint8_t conflicts[HEURISTIC_LINE_KEYS];
+
+    // Current linear-conflict penalty of every row and column
+    uint8_t row_lc[PACKED_MAX_SIZE];
+    uint8_t col_lc[PACKED_MAX_SIZE];
+
+    // Pattern databases replace linear conflicts when attached: each tile
+    // maps to its pattern and slot, and each pattern keeps its placement
+    const PdbSet *pdb;
+    int8_t tile_pattern[PACKED_MAX_CELLS];
+    int8_t tile_slot[PACKED_MAX_CELLS];
+    uint8_t pattern_cells[PDB_MAX_PATTERNS][PDB_MAX_PATTERN_TILES];
+    uint8_t pattern_excess[PDB_MAX_PATTERNS];
+
+    int bound;
+    int next_bound;
+    int length;
+    uint64_t nodes;
+    uint8_t path[SOLVER_MAX_MOVES];
+
+    // Zobrist key of the current board, kept up to date move by move, and
+    // the transposition table it is looked up in, if any
+    uint64_t key;
+    TransTable *table;
+    TransTableStats table_stats;
+
+    // Parallel mode: bound shared by all workers, lowered below this
+    // context's bound as soon as any worker finds a solution
+    const int *shared_bound;
+
+    // Progress reporting and cancellation, if requested
+    SolverControl *control;
+    uint64_t reported_nodes;
+    int stopped;
+} SearchContext;
+
+static void build_tables(SearchContext *ctx, int size) {
+    int cells = size * size;
+    ctx->size = size;
+    ctx->cells = cells;
+
+    for (int cell = 0; cell < cells; cell++) {
+        int x = cell % size;
+        int y = cell / size;
+        ctx->cell_x[cell] = (uint8_t)x;
+        ctx->cell_y[cell] = (uint8_t)y;
+        ctx->neighbors[cell][MOVE_LEFT] = (int8_t)(x > 0 ? cell - 1 : -1);
+        ctx->neighbors[cell][MOVE_RIGHT] = (int8_t)(x < size - 1 ? cell + 1 : -1);
+        ctx->neighbors[cell][MOVE_UP] = (int8_t)(y > 0 ? cell - size : -1);
+        ctx->neighbors[cell][MOVE_DOWN] = (int8_t)(y < size - 1 ? cell + size : -1);
+    }
+
+    // Tile t belongs in cell t - 1; the empty tile (0) never counts
+    for (int tile = 0; tile < cells; tile++) {
+        int gx = tile ? (tile - 1) % size : 0;
+        int gy = tile ? (tile - 1) / size : 0;
+        for (int cell = 0; cell < cells; cell++) {
+            int dx = ctx->cell_x[cell] - gx;
+            int dy = ctx->cell_y[cell] - gy;
+            ctx->md[tile][cell] = tile ? (uint8_t)((dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy)) : 0;
+        }
+        for (int line = 0; line < size; line++) {
+            ctx->row_code[tile][line] = (uint8_t)(tile && gy == line ? gx : size);
+            ctx->col_code[tile][line] = (uint8_t)(tile && gx == line ? gy : size);
+        }
+    }
+
+    // Line keys as heuristic_line_penalty reads them
+    int keys = 1;
+    for (int i = 0; i < size; i++) {
+        ctx->place[i] = keys;
+        keys *= size + 1;
+    }
+    for (int key = 0; key < keys; key++) {
+        ctx->conflicts[key] = (uint8_t)heuristic_line_penalty(size, key);
+    }
+}
+
+static int row_conflicts(const SearchContext *ctx, int row) {
+    const uint8_t *cell = &ctx->tiles[row * ctx->size];
+    int key = 0;
+    for (int x = 0; x < ctx->size; x++) {
+        key += ctx->row_code[cell[x]][row] * ctx->place[x];
+    }
+    return ctx->conflicts[key];
+}
+
+static int col_conflicts(const SearchContext *ctx, int col) {
+    const uint8_t *cell = &ctx->tiles[col];
+    int key = 0;
+    for (int y = 0; y < ctx->size; y++) {
+        key += ctx->col_code[cell[y * ctx->size]][col] * ctx->place[y];
+    }
+    return ctx->conflicts[key];
+}
+
+// Extra moves the pattern database adds on top of Manhattan distance
+static int pattern_excess(const SearchContext *ctx, int pattern) {
+    const PdbPattern *pdb = &ctx->pdb->patterns[pattern];
+    uint64_t index = pdb_index(ctx->pattern_cells[pattern], pdb->tile_count, ctx->cells);
+    return 2 * pdb_nibble(pdb, index);
+}
+
+// Build the per-size tables and attach the pattern databases (if sizes match)
+static void context_init(SearchContext *ctx, int size, const PdbSet *pdb) {
+    build_tables(ctx, size);
+    ctx->shared_bound = NULL;
+    ctx->control = NULL;
+    ctx->nodes = 0;
+    ctx->reported_nodes = 0;
+    ctx->stopped = 0;
+    ctx->table = NULL;
+    memset(&ctx->table_stats, 0, sizeof(ctx->table_stats));
+
+    ctx->pdb = (pdb && pdb->size == size) ? pdb : NULL;
+    if (ctx->pdb) {
+        for (int p = 0; p < pdb->pattern_count; p++) {
+            for (int i = 0; i < pdb->patterns[p].tile_count; i++) {
+                int tile = pdb->patterns[p].tiles[i];
+                ctx->tile_pattern[tile] = (int8_t)p;
+                ctx->tile_slot[tile] = (int8_t)i;
+            }
+        }
+    }
+}
+
+// Load a board into an initialised context and return its heuristic value
+static int context_load(SearchContext *ctx, const PackedBoard *pb) {
+    int h = 0;
+
+    for (int cell = 0; cell < ctx->cells; cell++) {
+        ctx->tiles[cell] = (uint8_t)packed_get(pb, cell);
+        h += ctx->md[ctx->tiles[cell]][cell];
+    }
+    ctx->blank = pb->empty;
+    ctx->key = zobrist_key(pb);
+
+    if (ctx->pdb) {
+        for (int cell = 0; cell < ctx->cells; cell++) {
+            int tile = ctx->tiles[cell];
+            if (tile) {
+                ctx->pattern_cells[ctx->tile_pattern[tile]][ctx->tile_slot[tile]] = (uint8_t)cell;
+            }
+        }
+        for (int p = 0; p < ctx->pdb->pattern_count; p++) {
+            ctx->pattern_excess[p] = (uint8_t)pattern_excess(ctx, p);
+            h += ctx->pattern_excess[p];
+        }
+        return h;
+    }
+
+    for (int line = 0; line < ctx->size; line++) {
+        ctx->row_lc[line] = (uint8_t)row_conflicts(ctx, line);
+        ctx->col_lc[line] = (uint8_t)col_conflicts(ctx, line);
+        h += ctx->row_lc[line] + ctx->col_lc[line];
+    }
+    return h;
+}
+
+// Heuristic change from the tile that just slid from cell into blank
+static int pattern_delta(SearchContext *ctx, int tile, int blank) {
+    int p = ctx->tile_pattern[tile];
+    int old_excess = ctx->pattern_excess[p];
+
+    ctx->pattern_cells[p][ctx->tile_slot[tile]] = (uint8_t)blank;
+    ctx->pattern_excess[p] = (uint8_t)pattern_excess(ctx, p);
+    return ctx->pattern_excess[p] - old_excess;
+}
+
+static void pattern_undo(SearchContext *ctx, int tile, int cell, int old_excess) {
+    int p = ctx->tile_pattern[tile];
+    ctx->pattern_cells[p][ctx->tile_slot[tile]] = (uint8_t)cell;
+    ctx->pattern_excess[p] = (uint8_t)old_excess;
+}
+
+static int line_delta(SearchContext *ctx, int dir, int blank, int cell,
+                      uint8_t **lines, int *a, int *b, uint8_t *old_a, uint8_t *old_b) {
+    // A horizontal slide only changes the two columns involved, a vertical
+    // slide only the two rows
+    if (dir == MOVE_LEFT || dir == MOVE_RIGHT) {
+        *lines = ctx->col_lc;
+        *a = ctx->cell_x[blank];
+        *b = ctx->cell_x[cell];
+        *old_a = ctx->col_lc[*a];
+        *old_b = ctx->col_lc[*b];
+        ctx->col_lc[*a] = (uint8_t)col_conflicts(ctx, *a);
+        ctx->col_lc[*b] = (uint8_t)col_conflicts(ctx, *b);
+    } else {
+        *lines = ctx->row_lc;
+        *a = ctx->cell_y[blank];
+        *b = ctx->cell_y[cell];
+        *old_a = ctx->row_lc[*a];
+        *old_b = ctx->row_lc[*b];
+        ctx->row_lc[*a] = (uint8_t)row_conflicts(ctx, *a);
+        ctx->row_lc[*b] = (uint8_t)row_conflicts(ctx, *b);
+    }
+    return (*lines)[*a] + (*lines)[*b] - *old_a - *old_b;
+}
+
+// Publish nodes expanded since the last report; returns 1 once cancelled
+static int report_progress(SearchContext *ctx) {
+    __atomic_fetch_add(&ctx->control->nodes, ctx->nodes - ctx->reported_nodes, __ATOMIC_RELAXED);
+    ctx->reported_nodes = ctx->nodes;
+    ctx->stopped = __atomic_load_n(&ctx->control->cancel, __ATOMIC_RELAXED);
+    return ctx->stopped;
+}
+
+// What a slide changed, so it can be taken back
+typedef struct {
+    int tile;
+    int cell;      // Where the tile came from (the new blank)
+    int blank;     // Where it went
+    uint8_t *lines;
+    int a, b;
+    uint8_t old_a, old_b;
+    int old_excess;
+    uint64_t key;
+} MoveUndo;
+
+// Slide the tile at cell into the blank; returns the child's heuristic
+static inline int make_move(SearchContext *ctx, int dir, int cell, int h, MoveUndo *undo) {
+    int blank = ctx->blank;
+    int tile = ctx->tiles[cell];
+
+    undo->tile = tile;
+    undo->cell = cell;
+    undo->blank = blank;
+    undo->key = ctx->key;
+    ctx->key ^= zobrist[tile][cell] ^ zobrist[tile][blank];
+    h += ctx->md[tile][blank] - ctx->md[tile][cell];
+    ctx->tiles[blank] = (uint8_t)tile;
+    ctx->tiles[cell] = 0;
+    ctx->blank = cell;
+
+    if (ctx->pdb) {
+        undo->lines = NULL;
+        undo->a = undo->b = 0;
+        undo->old_a = undo->old_b = 0;
+        undo->old_excess = ctx->pattern_excess[ctx->tile_pattern[tile]];
+        return h + pattern_delta(ctx, tile, blank);
+    }
+    undo->old_excess = 0;
+    return h + line_delta(ctx, dir, blank, cell, &undo->lines, &undo->a, &undo->b,
+                          &undo->old_a, &undo->old_b);
+}
+
+static inline void undo_move(SearchContext *ctx, const MoveUndo *undo) {
+    if (ctx->pdb) {
+        pattern_undo(ctx, undo->tile, undo->cell, undo->old_excess);
+    } else {
+        undo->lines[undo->a] = undo->old_a;
+        undo->lines[undo->b] = undo->old_b;
+    }
+    ctx->tiles[undo->cell] = (uint8_t)undo->tile;
+    ctx->tiles[undo->blank] = 0;
+    ctx->blank = undo->blank;
+    ctx->key = undo->key;
+}
+
+// Depth-first probe bounded by ctx->bound; h is updated by deltas only
+static int search(SearchContext *ctx, int g, int h, int prev_dir) {
+    int f = g + h;
+    if (f > ctx->bound) {
+        if (f < ctx->next_bound) {
+            ctx->next_bound = f;
+        }
+        return 0;
+    }
+    if (h == 0) {
+        ctx->length = g;
+        return 1;
+    }
+    if (ctx->stopped || (ctx->shared_bound &&
+        __atomic_load_n(ctx->shared_bound, __ATOMIC_RELAXED) < ctx->bound)) {
+        return 0;
+    }
+    if (ctx->table && ctx->bound - f >= TT_MIN_SLACK &&
+        tt_visit(ctx->table, ctx->key, g, ctx->bound, &ctx->table_stats)) {
+        return 0;
+    }
+
+    if ((++ctx->nodes & (CONTROL_INTERVAL - 1)) == 0 && ctx->control && report_progress(ctx)) {
+        return 0;
+    }
+    int blank = ctx->blank;
+
+    for (int dir = 0; dir < MOVE_COUNT; dir++) {
+        // Never undo the previous move (LEFT/RIGHT and UP/DOWN pair up)
+        if (dir == (prev_dir ^ 1)) {
+            continue;
+        }
+        int cell = ctx->neighbors[blank][dir];
+        if (cell < 0) {
+            continue;
+        }
+
+        MoveUndo undo;
+        int child_h = make_move(ctx, dir, cell, h, &undo);
+        int found = search(ctx, g + 1, child_h, dir);
+        undo_move(ctx, &undo);
+
+        if (found) {
+            ctx->path[g] = (uint8_t)dir;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int solver_is_solvable(const PackedBoard *pb) {
+    int size = pb->size;
+    int cells = size * size;
+    int inversions = 0;
+
+    for (int i = 0; i < cells; i++) {
+        int a = packed_get(pb, i);
+        if (a == 0) continue;
+        for (int j = i + 1; j < cells; j++) {
+            int b = packed_get(pb, j);
+            if (b != 0 && b < a) {
+                inversions++;
+            }
+        }
+    }
+
+    // On even widths a vertical move flips inversion parity and changes
+    // the empty tile's row, so their sum is the invariant
+    if (size % 2 == 0) {
+        inversions += size - 1 - pb->empty / size;
+    }
+    return inversions % 2 == 0;
+}
+
+int solver_heuristic(const PackedBoard *pb) {
+    SearchContext ctx;
+    context_init(&ctx, pb->size, NULL);
+    return context_load(&ctx, pb);
+}
+
+void solver_cancel(SolverControl *control) {
+    __atomic_store_n(&control->cancel, 1, __ATOMIC_RELAXED);
+}
+
+void solver_progress(const SolverControl *control, int *bound, uint64_t *nodes) {
+    *bound = __atomic_load_n(&control->bound, __ATOMIC_RELAXED);
+    *nodes = __atomic_load_n(&control->nodes, __ATOMIC_RELAXED);
+}
+
+static void report_bound(SolverControl *control, int bound) {
+    if (control) {
+        __atomic_store_n(&control->bound, bound, __ATOMIC_RELAXED);
+    }
+}
+
+static int is_cancelled(const SolverControl *control) {
+    return control && __atomic_load_n(&control->cancel, __ATOMIC_RELAXED);
+}
+
+int solver_solve(const PackedBoard *start, SolverResult *result) {
+    return solver_solve_with(start, NULL, result);
+}
+
+// Parallel search
+// The top plies of the tree are expanded breadth-first into a frontier of
+// subtrees. Every iteration deals the subtrees round-robin into one queue
+// per worker; workers drain their own queue from the back and steal from
+// the front of the others'. Queues are only filled between iterations, so a
+// packed (front, back) word updated by compare-and-swap is all the
+// synchronisation they need.
+
+// Frontier depth limit and target subtrees per worker
+#define FRONTIER_MAX_DEPTH 16
+#define FRONTIER_PER_WORKER 32
+#define SOLVER_MAX_THREADS 64
+
+typedef struct {
+    PackedBoard board;
+    uint8_t depth;
+    int8_t prev_dir;
+    uint16_t estimate;  // depth + heuristic
+    uint8_t path[FRONTIER_MAX_DEPTH];
+} FrontierNode;
+
+typedef struct {
+    uint32_t *items;     // Frontier node indexes
+    uint64_t range;      // (front << 32) | back, both item offsets
+} WorkQueue;
+
+typedef struct {
+    const FrontierNode *frontier;
+    WorkQueue queues[SOLVER_MAX_THREADS];
+    int worker_count;
+    int size;
+    const PdbSet *pdb;
+    SolverControl *control;
+    TransTable *table;
+
+    int bound;           // Lowered without locks once a solution is found
+    int next_bound;      // Smallest f above the bound seen by any worker
+    int found;
+    uint64_t nodes;
+    int length;
+    uint8_t moves[SOLVER_MAX_MOVES];
+} ParallelSearch;
+
+typedef struct {
+    ParallelSearch *shared;
+    int id;
+} Worker;
+
+static int queue_take(WorkQueue *queue, int steal, uint32_t *item) {
+    uint64_t range = __atomic_load_n(&queue->range, __ATOMIC_ACQUIRE);
+
+    for (;;) {
+        uint32_t front = (uint32_t)(range >> 32);
+        uint32_t back = (uint32_t)range;
+        if (front >= back) {
+            return 0;
+        }
+
+        uint64_t taken = steal ? range + ((uint64_t)1 << 32) : range - 1;
+        uint32_t slot = steal ? front : back - 1;
+        if (__atomic_compare_exchange_n(&queue->range, &range, taken, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *item = queue->items[slot];
+            return 1;
+        }
+    }
+}
+
+static void atomic_min(int *target, int value) {
+    int current = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while (value < current &&
+           !__atomic_compare_exchange_n(target, &current, value, 0,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void *worker_main(void *arg) {
+    Worker *worker = arg;
+    ParallelSearch *shared = worker->shared;
+    SearchContext ctx;
+
+    context_init(&ctx, shared->size, shared->pdb);
+    ctx.bound = __atomic_load_n(&shared->bound, __ATOMIC_RELAXED);
+    ctx.next_bound = INT_MAX;
+    ctx.shared_bound = &shared->bound;
+    ctx.control = shared->control;
+    ctx.table = shared->table;
+
+    for (int victim = 0; !ctx.stopped && victim < shared->worker_count; victim++) {
+        WorkQueue *queue = &shared->queues[(worker->id + victim) % shared->worker_count];
+        uint32_t item;
+
+        while (queue_take(queue, victim != 0, &item)) {
+            if (ctx.stopped || __atomic_load_n(&shared->bound, __ATOMIC_RELAXED) < ctx.bound) {
+                break;
+            }
+
+            const FrontierNode *node = &shared->frontier[item];
+            int h = context_load(&ctx, &node->board);
+            memcpy(ctx.path, node->path, node->depth);
+
+            if (search(&ctx, node->depth, h, node->prev_dir) &&
+                !__atomic_exchange_n(&shared->found, 1, __ATOMIC_ACQ_REL)) {
+                shared->length = ctx.length;
+                memcpy(shared->moves, ctx.path, (size_t)ctx.length);
+                atomic_min(&shared->bound, ctx.length - 1);
+            }
+        }
+    }
+
+    atomic_min(&shared->next_bound, ctx.next_bound);
+    __atomic_fetch_add(&shared->nodes, ctx.nodes, __ATOMIC_RELAXED);
+    if (ctx.table) {
+        tt_add_stats(ctx.table, &ctx.table_stats);
+    }
+    if (ctx.control) {
+        report_progress(&ctx);
+    }
+    return NULL;
+}
+
+// Expand the tree breadth-first until every worker has enough subtrees;
+// returns the frontier size, or -1 with the result filled if a solution
+// turned up inside the frontier itself
+static int expand_frontier(const PackedBoard *start, int workers, Arena *arena,
+                           FrontierNode **out, SolverResult *result) {
+    FrontierNode *layer = arena_alloc(arena, sizeof(FrontierNode));
+    size_t count = 1;
+
+    if (!layer) {
+        return 0;
+    }
+    memset(&layer[0], 0, sizeof(FrontierNode));
+    layer[0].board = *start;
+    layer[0].prev_dir = -1;
+
+    for (int depth = 0; depth < FRONTIER_MAX_DEPTH &&
+                        count < (size_t)workers * FRONTIER_PER_WORKER; depth++) {
+        size_t next_capacity = count * 3 + 4;
+        FrontierNode *next = arena_alloc(arena, next_capacity * sizeof(FrontierNode));
+        size_t next_count = 0;
+        if (!next) {
+            break;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            for (int dir = 0; dir < MOVE_COUNT; dir++) {
+                if (dir == (layer[i].prev_dir ^ 1)) {
+                    continue;
+                }
+                FrontierNode child = layer[i];
+                if (!packed_move(&child.board, dir)) {
+                    continue;
+                }
+                child.path[child.depth++] = (uint8_t)dir;
+                child.prev_dir = (int8_t)dir;
+
+                if (packed_is_solved(&child.board)) {
+                    result->status = SOLVER_SOLVED;
+                    result->length = child.depth;
+                    memcpy(result->moves, child.path, child.depth);
+                    return -1;
+                }
+                next[next_count++] = child;
+            }
+        }
+        layer = next;
+        count = next_count;
+    }
+
+    *out = layer;
+    return (int)count;
+}
+
+static int compare_estimates(const void *a, const void *b) {
+    const FrontierNode *x = a, *y = b;
+    return (int)y->estimate - (int)x->estimate;
+}
+
+// Highest estimates first: owners drain their queues from the back, so each
+// worker starts on its most promising subtrees and thieves take the rest
+static void order_frontier(FrontierNode *frontier, int count, Arena *arena) {
+    PackedBoard *boards = arena_alloc(arena, (size_t)count * sizeof(PackedBoard));
+    StateScore *scores = arena_alloc(arena, (size_t)count * sizeof(StateScore));
+
+    if (boards && scores) {
+        for (int i = 0; i < count; i++) {
+            boards[i] = frontier[i].board;
+        }
+        if (heuristic_score(boards, (size_t)count, scores)) {
+            for (int i = 0; i < count; i++) {
+                frontier[i].estimate = (uint16_t)(frontier[i].depth + scores[i].total);
+            }
+            qsort(frontier, (size_t)count, sizeof(FrontierNode), compare_estimates);
+        }
+    }
+}
+
+static int initial_bound(const PackedBoard *start, const PdbSet *pdb) {
+    SearchContext ctx;
+    context_init(&ctx, start->size, pdb);
+    return context_load(&ctx, start);
+}
+
+static int solve_parallel(const PackedBoard *start, const SolverConfig *config,
+                          int threads, Arena *arena, SolverResult *result) {
+    FrontierNode *frontier = NULL;
+    int count = expand_frontier(start, threads, arena, &frontier, result);
+
+    if (count < 0) {
+        return 1;
+    }
+    if (count == 0) {
+        // Out of memory: SOLVER_SOLVED is 0, so the zeroed result must not stand
+        result->status = SOLVER_UNSUPPORTED;
+        return 0;
+    }
+    order_frontier(frontier, count, arena);
+
+    int per = (count + threads - 1) / threads;
+    ParallelSearch *shared = arena_calloc(arena, 1, sizeof(ParallelSearch));
+    uint32_t *items = arena_alloc(arena, (size_t)per * (size_t)threads * sizeof(uint32_t));
+    pthread_t handles[SOLVER_MAX_THREADS];
+    Worker workers[SOLVER_MAX_THREADS];
+    int solved = 0;
+
+    if (shared && items) {
+        shared->frontier = frontier;
+        shared->worker_count = threads;
+        shared->size = start->size;
+        shared->pdb = config->pdb;
+        shared->control = config->control;
+        shared->table = config->table;
+        shared->bound = initial_bound(start, config->pdb);
+        if (shared->table) {
+            tt_begin(shared->table);
+        }
+
+        while (shared->bound < SOLVER_MAX_MOVES && !is_cancelled(config->control)) {
+            report_bound(config->control, shared->bound);
+
+            // Deal subtrees round-robin; queue w owns items [w * per, ...)
+            for (int w = 0; w < threads; w++) {
+                uint32_t back = 0;
+                shared->queues[w].items = items + (size_t)w * per;
+                for (int i = w; i < count; i += threads) {
+                    shared->queues[w].items[back++] = (uint32_t)i;
+                }
+                shared->queues[w].range = back;
+            }
+            shared->next_bound = INT_MAX;
+
+            int started = 0;
+            for (; started < threads; started++) {
+                workers[started].shared = shared;
+                workers[started].id = started;
+                if (pthread_create(&handles[started], NULL, worker_main, &workers[started]) != 0) {
+                    break;
+                }
+            }
+            if (started == 0) {
+                worker_main(&(Worker){shared, 0});
+            }
+            for (int w = 0; w < started; w++) {
+                pthread_join(handles[w], NULL);
+            }
+
+            if (shared->found) {
+                result->status = SOLVER_SOLVED;
+                result->length = shared->length;
+                memcpy(result->moves, shared->moves, (size_t)shared->length);
+                solved = 1;
+                break;
+            }
+            shared->bound = shared->next_bound;
+        }
+        result->nodes = shared->nodes;
+    }
+
+    if (!solved) {
+        result->status = is_cancelled(config->control) ? SOLVER_CANCELLED : SOLVER_UNSUPPORTED;
+    }
+    return solved;
+}
+
+// Bidirectional search
+// The backward half is a breadth-first search from the goal into an
+// open-addressing table of Zobrist keys, each entry holding the key with its
+// low byte replaced by depth + 1 (0 marks a free slot). Every board within
+// `complete` moves of the goal is in the table, so a board missing from it
+// is at least complete + 1 away, which the forward search uses whenever it
+// beats the heuristic. Keys keep 56 bits; a collision can only produce a
+// path that fails the final check, and the search then carries on.
+
+// Costs are scaled by 100 so heuristic weights can be given in percent
+#define COST_SCALE 100
+
+typedef struct {
+    uint64_t *table;
+    uint64_t mask;
+    uint32_t states;
+    uint32_t max_states;
+    int complete;   // Deepest layer stored in full
+    int deepest;    // Deepest layer with any board stored
+    uint64_t nodes; // Boards expanded backward
+} Perimeter;
+
+// Depth of a stored board, or -1
+static int perimeter_find(const Perimeter *p, uint64_t key) {
+    uint64_t tag = key & ~(uint64_t)0xFF;
+
+    for (uint64_t slot = (key >> 8) & p->mask;; slot = (slot + 1) & p->mask) {
+        uint64_t entry = p->table[slot];
+        if (entry == 0) {
+            return -1;
+        }
+        if ((entry & ~(uint64_t)0xFF) == tag) {
+            return (int)(entry & 0xFF) - 1;
+        }
+    }
+}
+
+// Returns 1 if stored, 0 if already there, -1 once the table is full
+static int perimeter_insert(Perimeter *p, uint64_t key, int depth) {
+    uint64_t tag = key & ~(uint64_t)0xFF;
+    uint64_t slot = (key >> 8) & p->mask;
+
+    for (; p->table[slot]; slot = (slot + 1) & p->mask) {
+        if ((p->table[slot] & ~(uint64_t)0xFF) == tag) {
+            return 0;
+        }
+    }
+    if (p->states >= p->max_states) {
+        return -1;
+    }
+    p->table[slot] = tag | (uint64_t)(depth + 1);
+    p->states++;
+    return 1;
+}
+
+// Breadth-first layers from the goal until the table is full or the whole
+// state space is stored; two layers of boards are held while building
+static int perimeter_build(Perimeter *p, int size, const SolverControl *control, Arena *arena) {
+    PackedBoard *layer = arena_alloc(arena, sizeof(PackedBoard));
+    size_t count = 1;
+    int ok = layer != NULL;
+
+    if (ok) {
+        packed_init(&layer[0], size);
+        perimeter_insert(p, zobrist_key(&layer[0]), 0);
+    }
+
+    for (int depth = 0; ok; depth++) {
+        size_t room = p->max_states - p->states;
+        size_t capacity = count * 3 + 1 < room ? count * 3 + 1 : room;
+        PackedBoard *next = arena_alloc(arena, (capacity ? capacity : 1) * sizeof(PackedBoard));
+        size_t next_count = 0;
+        int full = 0;
+
+        if (!next) {
+            ok = 0;
+            break;
+        }
+        for (size_t i = 0; i < count && !full; i++) {
+            if ((++p->nodes & (CONTROL_INTERVAL - 1)) == 0 && is_cancelled(control)) {
+                ok = 0;
+                break;
+            }
+            uint64_t key = zobrist_key(&layer[i]);
+            for (int dir = 0; dir < MOVE_COUNT; dir++) {
+                int cell = packed_neighbor(&layer[i], dir);
+                if (cell < 0) {
+                    continue;
+                }
+                int tile = packed_get(&layer[i], cell);
+                uint64_t child = key ^ zobrist[tile][cell] ^ zobrist[tile][layer[i].empty];
+                int stored = perimeter_insert(p, child, depth + 1);
+                if (stored < 0) {
+                    full = 1;
+                    break;
+                }
+                if (stored) {
+                    next[next_count] = layer[i];
+                    packed_move_cell(&next[next_count++], cell);
+                }
+            }
+        }
+        layer = next;
+        count = next_count;
+
+        // A cut-off layer stays in the table; its depths are still exact
+        if (next_count > 0) {
+            p->deepest = depth + 1;
+        }
+        if (full || next_count == 0) {
+            p->complete = full ? depth : depth + 1;
+            break;
+        }
+    }
+    return ok;
+}
+
+// Scaled f of a forward node: exact if the table has it, else the weighted
+// larger of the heuristic and the table's guarantee; depth gets the stored
+// distance or -1
+static int perimeter_cost(const Perimeter *p, int weight, int g, int h, uint64_t key, int *depth) {
+    // No board in the table is further than deepest, and h never overestimates
+    *depth = h <= p->deepest ? perimeter_find(p, key) : -1;
+    if (*depth >= 0) {
+        return COST_SCALE * (g + *depth);
+    }
+    // Distance and heuristic share their parity, so the guarantee rounds up to it
+    int estimate = h > p->complete ? h : p->complete + 1 + ((p->complete + 1 + h) & 1);
+    return COST_SCALE * g + weight * estimate;
+}
+
+// Follow the table downhill from the meeting board to the goal
+static int perimeter_path(SearchContext *ctx, const Perimeter *p, int g, int depth, uint64_t key) {
+    uint8_t tiles[PACKED_MAX_CELLS];
+    int blank = ctx->blank;
+
+    memcpy(tiles, ctx->tiles, (size_t)ctx->cells);
+    for (int step = depth; step > 0; step--) {
+        int dir = 0;
+        for (; dir < MOVE_COUNT; dir++) {
+            int cell = ctx->neighbors[blank][dir];
+            if (cell < 0) {
+                continue;
+            }
+            uint64_t child = key ^ zobrist[tiles[cell]][cell] ^ zobrist[tiles[cell]][blank];
+            if (perimeter_find(p, child) == step - 1) {
+                tiles[blank] = tiles[cell];
+                tiles[cell] = 0;
+                blank = cell;
+                key = child;
+                break;
+            }
+        }
+        if (dir == MOVE_COUNT) {
+            return 0;
+        }
+        ctx->path[g + depth - step] = (uint8_t)dir;
+    }
+
+    for (int cell = 0; cell < ctx->cells - 1; cell++) {
+        if (tiles[cell] != cell + 1) {
+            return 0;
+        }
+    }
+    ctx->length = g + depth;
+    return 1;
+}
+
+// Forward searches share the table; with several threads each searches
+// with a larger weight than the last and the first path found wins
+#define BIDI_WEIGHT_STEP 25
+
+typedef struct {
+    const Perimeter *perimeter;
+    const PackedBoard *start;
+    const SolverConfig *config;
+    int weight;
+    int lead;        // Reports progress bounds (the lowest weight)
+    int *finished;   // Set by the first worker to find a path
+    int winner;
+    SearchContext ctx;
+} BidiWorker;
+
+// Forward IDA* against the table; bounds are scaled costs
+static int bidi_search(BidiWorker *worker, int g, int h, int prev_dir) {
+    SearchContext *ctx = &worker->ctx;
+    const Perimeter *p = worker->perimeter;
+    int depth;
+    int f = perimeter_cost(p, worker->weight, g, h, ctx->key, &depth);
+    if (f > ctx->bound) {
+        if (f < ctx->next_bound) {
+            ctx->next_bound = f;
+        }
+        return 0;
+    }
+    if (depth >= 0) {
+        return perimeter_path(ctx, p, g, depth, ctx->key);
+    }
+    if (ctx->stopped) {
+        return 0;
+    }
+
+    if ((++ctx->nodes & (CONTROL_INTERVAL - 1)) == 0) {
+        uint64_t limit = worker->config->node_limit;
+        ctx->stopped = __atomic_load_n(worker->finished, __ATOMIC_RELAXED) ||
+                       (limit && ctx->nodes >= limit);
+        if (ctx->stopped || (ctx->control && report_progress(ctx))) {
+            return 0;
+        }
+    }
+    int blank = ctx->blank;
+
+    // Children that bring their tile closer to home first: the first path
+    // under a weighted bound is the answer, so order decides its length
+    int order[MOVE_COUNT];
+    int count = 0;
+    for (int dir = 0; dir < MOVE_COUNT; dir++) {
+        int cell = ctx->neighbors[blank][dir];
+        if (dir == (prev_dir ^ 1) || cell < 0) {
+            continue;
+        }
+        int tile = ctx->tiles[cell];
+        if (worker->weight > COST_SCALE && ctx->md[tile][blank] < ctx->md[tile][cell]) {
+            memmove(order + 1, order, (size_t)count * sizeof(int));
+            order[0] = dir;
+        } else {
+            order[count] = dir;
+        }
+        count++;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int dir = order[i];
+        int cell = ctx->neighbors[blank][dir];
+
+        MoveUndo undo;
+        int child_h = make_move(ctx, dir, cell, h, &undo);
+        int found = bidi_search(worker, g + 1, child_h, dir);
+        undo_move(ctx, &undo);
+
+        if (found) {
+            ctx->path[g] = (uint8_t)dir;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *bidi_worker_main(void *arg) {
+    BidiWorker *worker = arg;
+    SearchContext *ctx = &worker->ctx;
+
+    context_init(ctx, worker->start->size, worker->config->pdb);
+    ctx->control = worker->config->control;
+    int h = context_load(ctx, worker->start);
+    int depth;
+    ctx->bound = perimeter_cost(worker->perimeter, worker->weight, 0, h, ctx->key, &depth);
+
+    while (ctx->bound < COST_SCALE * SOLVER_MAX_MOVES && !ctx->stopped) {
+        if (worker->lead) {
+            report_bound(ctx->control, ctx->bound / COST_SCALE);
+        }
+        ctx->next_bound = INT_MAX;
+        if (bidi_search(worker, 0, h, -1)) {
+            worker->winner = !__atomic_exchange_n(worker->finished, 1, __ATOMIC_ACQ_REL);
+            break;
+        }
+        ctx->bound = ctx->next_bound;
+    }
+    if (ctx->control) {
+        report_progress(ctx);
+    }
+    return NULL;
+}
+
+static int solve_bidirectional(const PackedBoard *start, const SolverConfig *config,
+                               Arena *arena, SolverResult *result) {
+    Perimeter *p = arena_calloc(arena, 1, sizeof(Perimeter));
+    int weight = config->weight > COST_SCALE ? config->weight : COST_SCALE;
+    int threads = weight > COST_SCALE && config->threads > 1 ? config->threads : 1;
+    BidiWorker *workers = NULL;
+    int finished = 0;
+    int solved = 0;
+
+    if (threads > SOLVER_MAX_THREADS) {
+        threads = SOLVER_MAX_THREADS;
+    }
+    if (!p) {
+        result->status = SOLVER_UNSUPPORTED;
+        return 0;
+    }
+    p->max_states = config->table_states ? config->table_states : SOLVER_DEFAULT_TABLE_STATES;
+
+    uint64_t slots = 2;
+    while (slots < (uint64_t)p->max_states * 2) {
+        slots *= 2;
+    }
+    p->mask = slots - 1;
+    p->table = arena_calloc(arena, (size_t)slots, sizeof(uint64_t));
+    workers = arena_calloc(arena, (size_t)threads, sizeof(BidiWorker));
+
+    if (p->table && workers && perimeter_build(p, start->size, config->control, arena)) {
+        pthread_t handles[SOLVER_MAX_THREADS];
+        int started = 0;
+
+        for (int w = 0; w < threads; w++) {
+            workers[w].perimeter = p;
+            workers[w].start = start;
+            workers[w].config = config;
+            workers[w].weight = weight + w * BIDI_WEIGHT_STEP;
+            workers[w].lead = w == 0;
+            workers[w].finished = &finished;
+        }
+        for (; started < threads - 1; started++) {
+            if (pthread_create(&handles[started], NULL, bidi_worker_main, &workers[started + 1]) != 0) {
+                break;
+            }
+        }
+        bidi_worker_main(&workers[0]);
+        for (int w = 0; w < started; w++) {
+            pthread_join(handles[w], NULL);
+        }
+
+        result->nodes = p->nodes;
+        for (int w = 0; w <= started; w++) {
+            result->nodes += workers[w].ctx.nodes;
+            if (workers[w].winner) {
+                result->status = SOLVER_SOLVED;
+                result->length = workers[w].ctx.length;
+                memcpy(result->moves, workers[w].ctx.path, (size_t)result->length);
+                solved = 1;
+            }
+        }
+    }
+
+    if (!solved) {
+        result->status = is_cancelled(config->control) ? SOLVER_CANCELLED : SOLVER_UNSUPPORTED;
+    }
+    return solved;
+}
+
+int solver_solve_with(const PackedBoard *start, const SolverConfig *config,
+                      SolverResult *result) {
+    SearchContext ctx;
+
+    memset(result, 0, sizeof(*result));
+    if (start->size < 3 || start->size > PACKED_MAX_SIZE) {
+        result->status = SOLVER_UNSUPPORTED;
+        return 0;
+    }
+    if (!solver_is_solvable(start)) {
+        result->status = SOLVER_UNSOLVABLE;
+        return 0;
+    }
+    if (packed_is_solved(start)) {
+        result->status = SOLVER_SOLVED;
+        return 1;
+    }
+
+    int threads = config ? config->threads : 1;
+    if (threads > SOLVER_MAX_THREADS) {
+        threads = SOLVER_MAX_THREADS;
+    }
+    if ((config && config->engine == SOLVER_ENGINE_BIDIRECTIONAL) || threads > 1) {
+        // Scratch memory comes from the caller's arena, or one for this solve
+        Arena local;
+        Arena *arena = config->arena;
+        if (!arena) {
+            arena = &local;
+            arena_init(arena, 0);
+        }
+        int solved = config->engine == SOLVER_ENGINE_BIDIRECTIONAL
+                         ? solve_bidirectional(start, config, arena, result)
+                         : solve_parallel(start, config, threads, arena, result);
+        if (arena == &local) {
+            arena_free(arena);
+        } else {
+            arena_reset(arena);
+        }
+        return solved;
+    }
+
+    context_init(&ctx, start->size, config ? config->pdb : NULL);
+    ctx.control = config ? config->control : NULL;
+    ctx.table = config ? config->table : NULL;
+    if (ctx.table) {
+        tt_begin(ctx.table);
+    }
+    int h = context_load(&ctx, start);
+    ctx.bound = h;
+
+    int solved = 0;
+    while (ctx.bound < SOLVER_MAX_MOVES && !ctx.stopped) {
+        report_bound(ctx.control, ctx.bound);
+        ctx.next_bound = INT_MAX;
+        if (search(&ctx, 0, h, -1)) {
+            result->status = SOLVER_SOLVED;
+            result->length = ctx.length;
+            memcpy(result->moves, ctx.path, (size_t)ctx.length);
+            solved = 1;
+            break;
+        }
+        ctx.bound = ctx.next_bound;
+    }
+
+    if (!solved) {
+        result->status = ctx.stopped ? SOLVER_CANCELLED : SOLVER_UNSUPPORTED;
+    }
+    result->nodes = ctx.nodes;
+    if (ctx.table) {
+        tt_add_stats(ctx.table, &ctx.table_stats);
+    }
+    return solved;
+}
@@ -0,0 +1,85 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdint.h>
+#include "arena.h"
+#include "bitboard.h"
+#include "pdb.h"
+#include "transtable.h"
+
+// Longest solution the solver can return (5x5 optimum is at most 208)
+#define SOLVER_MAX_MOVES 256
+
+// Smallest size optimal IDA* cannot finish without pattern databases: on
+// Manhattan distance and linear conflicts alone a 5x5 search runs for days
+#define SOLVER_PDB_MIN_SIZE 5
+
+typedef enum {
+    SOLVER_SOLVED,
+    SOLVER_UNSOLVABLE,
+    SOLVER_UNSUPPORTED,
+    SOLVER_CANCELLED
+} SolverStatus;
+
+// Solution as a sequence of empty-tile moves (MoveDirection values)
+typedef struct {
+    SolverStatus status;
+    int length;
+    uint8_t moves[SOLVER_MAX_MOVES];
+    uint64_t nodes;  // Nodes expanded across all iterations
+} SolverResult;
+
+// Shared with a search running on another thread: cancel stops it within a
+// few thousand nodes, bound and nodes report progress. Fields are accessed
+// atomically; use the helpers below from other threads.
+typedef struct {
+    int cancel;
+    int bound;       // Current IDA* cost threshold
+    uint64_t nodes;  // Nodes expanded so far
+} SolverControl;
+
+// Search engines
+// IDA*: optimal, parallel when threads > 1.
+// Bidirectional: a breadth-first search backward from the goal fills a
+// table of every board within a few dozen moves of it (as many complete
+// layers as table_states allows), then IDA* runs forward until it meets the
+// table, which supplies the rest of the path. Single-threaded. With weight
+// above 100 the forward heuristic is inflated and solutions may be longer
+// than optimal, but 5x5 boards finish in seconds.
+typedef enum {
+    SOLVER_ENGINE_IDA,
+    SOLVER_ENGINE_BIDIRECTIONAL
+} SolverEngine;
+
+// Backward table size used when table_states is 0 (16 bytes per state)
+#define SOLVER_DEFAULT_TABLE_STATES (1u << 16)
+
+// Optional search settings (a NULL config means the defaults)
+typedef struct {
+    const PdbSet *pdb;       // Additive pattern databases; used when sizes match
+    int threads;             // Worker threads; 0 or 1 searches on the caller
+    SolverControl *control;  // Cancellation and progress, optional
+    TransTable *table;       // IDA*: transposition table, optional; one solve at a time
+    Arena *arena;            // Scratch memory, optional; reset when the solve returns
+    SolverEngine engine;
+    int weight;              // Bidirectional: heuristic weight in percent (0: 100, optimal)
+    uint32_t table_states;   // Bidirectional: backward states kept (0: default)
+    uint64_t node_limit;     // Bidirectional: forward nodes per thread before giving up (0: none)
+} SolverConfig;
+
+// Parity test: can the board reach the solved state at all?
+int solver_is_solvable(const PackedBoard *pb);
+
+// Manhattan distance plus linear conflicts, computed from scratch
+int solver_heuristic(const PackedBoard *pb);
+
+void solver_cancel(SolverControl *control);
+void solver_progress(const SolverControl *control, int *bound, uint64_t *nodes);
+
+// Search with the configured engine (optimal IDA* by default); returns 1
+// and fills result on success
+int solver_solve(const PackedBoard *start, SolverResult *result);
+int solver_solve_with(const PackedBoard *start, const SolverConfig *config,
+                      SolverResult *result);
+
+#endif // SOLVER_H
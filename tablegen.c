@@ -0,0 +1,210 @@
+/**
+ * Taquin - Precomputed Table Generator
+ *
+ * Builds the solver's lookup tables ahead of time (no SDL required):
+ *   taquin-tables pdb <size> <partition> <output>   additive pattern databases
+ *   taquin-tables verify <file>                      check a database checksum
+ *   taquin-tables dist3 <output>                     exact 3x3 distance table
+ *   taquin-tables verify-dist <file>                 check a distance table
+ *   taquin-tables assets <output>                    compressed image pack
+ *   taquin-tables verify-assets <file>               decode every packed image
+ *   taquin-tables bfs <size> <dir> [mb] [depth]      distance histogram, spilled to disk
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "assetpack.h"
+#include "diskbfs.h"
+#include "disttable.h"
+#include "pdb.h"
+
+static int usage(void) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  taquin-tables pdb <size> <partition> <output>\n");
+    fprintf(stderr, "      partitions: 4 6-6-3, 4 7-8, 5 6-6-6-6\n");
+    fprintf(stderr, "  taquin-tables verify <file>\n");
+    fprintf(stderr, "  taquin-tables dist3 <output>\n");
+    fprintf(stderr, "  taquin-tables verify-dist <file>\n");
+    fprintf(stderr, "  taquin-tables assets <output>\n");
+    fprintf(stderr, "  taquin-tables verify-assets <file>\n");
+    fprintf(stderr, "  taquin-tables bfs <size> <work-dir> [memory-mb] [max-depth]\n");
+    fprintf(stderr, "      counts the boards at each distance from the goal; layers are\n");
+    fprintf(stderr, "      kept in <work-dir>, which needs about a byte per board\n");
+    return EXIT_FAILURE;
+}
+
+static int build_pdb(int size, const char *partition, const char *output) {
+    int pattern_count;
+    int tile_counts[PDB_MAX_PATTERNS];
+    uint8_t tiles[PDB_MAX_PATTERNS][PDB_MAX_PATTERN_TILES] = {{0}};
+    uint8_t *tables[PDB_MAX_PATTERNS] = {0};
+    int ok = 1;
+
+    if (!pdb_partition(size, partition, &pattern_count, tile_counts, tiles)) {
+        fprintf(stderr, "Unknown partition %s for %dx%d\n", partition, size, size);
+        return 0;
+    }
+
+    for (int p = 0; ok && p < pattern_count; p++) {
+        uint64_t entries = pdb_entry_count(size * size, tile_counts[p]);
+
+        printf("Pattern %d/%d (%d tiles, %llu entries):\n", p + 1, pattern_count,
+               tile_counts[p], (unsigned long long)entries);
+        tables[p] = malloc((size_t)((entries + 1) / 2));
+        ok = tables[p] && pdb_build(size, tile_counts[p], tiles[p], tables[p], stdout);
+    }
+
+    if (ok) {
+        ok = pdb_write(output, size, pattern_count, tile_counts, tiles, tables);
+    }
+    for (int p = 0; p < pattern_count; p++) {
+        free(tables[p]);
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Failed to build %s\n", output);
+        return 0;
+    }
+    printf("Wrote %s\n", output);
+    return 1;
+}
+
+static int verify_pdb(const char *path) {
+    PdbSet set;
+
+    if (!pdb_open(&set, path)) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 0;
+    }
+    int ok = pdb_verify(&set);
+    printf("%s: %dx%d, %d patterns, checksum %s\n", path, set.size, set.size,
+           set.pattern_count, ok ? "OK" : "MISMATCH");
+    pdb_close(&set);
+    return ok;
+}
+
+static int build_dist(const char *output) {
+    DistTable table;
+
+    if (!dist_build(&table, DIST_BOARD_SIZE)) {
+        fprintf(stderr, "Failed to build the distance table\n");
+        return 0;
+    }
+    int ok = dist_write(&table, output);
+    if (ok) {
+        printf("Wrote %s (%llu states, max distance %d)\n", output,
+               (unsigned long long)table.states, dist_max(&table));
+    } else {
+        fprintf(stderr, "Failed to write %s\n", output);
+    }
+    dist_free(&table);
+    return ok;
+}
+
+// Checksums on load, then every entry against its neighbours
+static int verify_dist(const char *path) {
+    DistTable table;
+
+    if (!dist_load(&table, path)) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 0;
+    }
+    int ok = dist_verify(&table);
+    printf("%s: %dx%d, %llu states, max distance %d, distances %s\n", path, table.size,
+           table.size, (unsigned long long)table.states, dist_max(&table),
+           ok ? "OK" : "INCONSISTENT");
+    dist_free(&table);
+    return ok;
+}
+
+static int build_assets(const char *output) {
+    printf("Packing images into %s:\n", output);
+    if (!asset_pack_build(output, stdout)) {
+        fprintf(stderr, "Failed to build %s\n", output);
+        return 0;
+    }
+    printf("Wrote %s\n", output);
+    return 1;
+}
+
+// Every image decodes and matches its checksum, and the pack is current
+static int verify_assets(const char *path) {
+    AssetPack pack;
+    int images = 0, ok = 1;
+
+    if (!asset_pack_open(&pack, path)) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 0;
+    }
+    uint8_t *rgba = malloc((size_t)ASSET_SCREEN_WIDTH * ASSET_SCREEN_HEIGHT * 4);
+    for (int asset = 0; rgba && asset < ASSET_COUNT; asset++) {
+        if (pack.header->entries[asset].width == 0) {
+            continue;
+        }
+        if (!asset_pack_verify(&pack, asset) || !asset_pack_decode(&pack, asset, rgba)) {
+            char source[64];
+            asset_path(asset, source, sizeof(source));
+            fprintf(stderr, "%s is corrupt\n", source);
+            ok = 0;
+        }
+        images++;
+    }
+    int current = pack.header->source_stamp == asset_source_stamp(NULL);
+    printf("%s: %d images, %zu bytes, images %s, %s\n", path, images, pack.file.size,
+           ok && rgba ? "OK" : "CORRUPT", current ? "up to date" : "older than the sources");
+    free(rgba);
+    asset_pack_close(&pack);
+    return ok && rgba != NULL;
+}
+
+// Boards at every distance from the goal, by disk-backed breadth-first search
+static int run_bfs(int argc, char *argv[]) {
+    DiskBfsConfig config = {0};
+    DiskBfsResult result;
+
+    config.size = atoi(argv[0]);
+    config.directory = argv[1];
+    config.memory_bytes = argc > 2 ? (size_t)atol(argv[2]) << 20 : 0;
+    config.max_depth = argc > 3 ? atoi(argv[3]) : 0;
+    config.log = stdout;
+
+    printf("Breadth-first search over %dx%d boards in %s:\n", config.size, config.size,
+           config.directory);
+    if (!diskbfs_run(&config, &result)) {
+        fprintf(stderr, "Search failed (board size 3 or 4, and a writable directory)\n");
+        return 0;
+    }
+    printf("%llu boards in %d layers%s, %s, %llu runs, %llu MB written, %llu MB read\n",
+           (unsigned long long)result.states, result.depth_count,
+           result.complete ? " (every solvable board)" : "",
+           result.used_bitmap ? "visited bitmap" : "duplicates dropped by merging",
+           (unsigned long long)result.runs, (unsigned long long)(result.bytes_written >> 20),
+           (unsigned long long)(result.bytes_read >> 20));
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 5 && strcmp(argv[1], "pdb") == 0) {
+        return build_pdb(atoi(argv[2]), argv[3], argv[4]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc == 3 && strcmp(argv[1], "verify") == 0) {
+        return verify_pdb(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc == 3 && strcmp(argv[1], "dist3") == 0) {
+        return build_dist(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc == 3 && strcmp(argv[1], "verify-dist") == 0) {
+        return verify_dist(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc == 3 && strcmp(argv[1], "assets") == 0) {
+        return build_assets(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc == 3 && strcmp(argv[1], "verify-assets") == 0) {
+        return verify_assets(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc >= 4 && argc <= 6 && strcmp(argv[1], "bfs") == 0) {
+        return run_bfs(argc - 2, argv + 2) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    return usage();
+}
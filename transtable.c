@@ -0,0 +1,46 @@
+#include <stdlib.h>
+#include <string.h>
+#include "transtable.h"
+
+int tt_init(TransTable *tt, size_t budget_bytes) {
+    uint64_t buckets = 1;
+
+    memset(tt, 0, sizeof(*tt));
+    while ((buckets * 2) * TT_BUCKET_BYTES <= budget_bytes) {
+        buckets *= 2;
+    }
+
+    // Over-allocate by a line so the buckets can start on a line boundary
+    size_t bytes = (size_t)buckets * TT_BUCKET_BYTES;
+    tt->block = calloc(1, bytes + TT_BUCKET_BYTES);
+    if (!tt->block) {
+        return 0;
+    }
+    uintptr_t start = ((uintptr_t)tt->block + TT_BUCKET_BYTES - 1) & ~(uintptr_t)(TT_BUCKET_BYTES - 1);
+    tt->entries = (uint64_t *)start;
+    tt->bucket_mask = buckets - 1;
+    tt->bytes = bytes;
+    return 1;
+}
+
+void tt_free(TransTable *tt) {
+    free(tt->block);
+    memset(tt, 0, sizeof(*tt));
+}
+
+void tt_begin(TransTable *tt) {
+    uint64_t epoch = (tt->epoch >> 16) + 1;
+
+    // Epochs wrap after 255 solves; clear then so no old entry can match
+    if (epoch > 0xFF) {
+        memset(tt->entries, 0, tt->bytes);
+        epoch = 1;
+    }
+    tt->epoch = epoch << 16;
+}
+
+void tt_add_stats(TransTable *tt, const TransTableStats *stats) {
+    __atomic_fetch_add(&tt->stats.probes, stats->probes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&tt->stats.hits, stats->hits, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&tt->stats.stores, stats->stores, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,93 @@
+#ifndef TRANSTABLE_H
+#define TRANSTABLE_H
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Transposition table for IDA*: a board reached again under the same bound
+// at no greater depth has nothing left to find, as its subtree is (or is
+// being) searched with at least as much budget. Fixed size, open-addressed
+// in buckets of eight entries that each fill one cache line. An entry is one
+// 64-bit word read and written atomically, so any number of threads probe
+// and store without locks; a race only loses an entry, never corrupts one.
+//
+// Entry: key tag (40 bits) | solve epoch (8) | depth (8) | bound (8)
+// The epoch ties entries to one solve, so a table is reused without
+// clearing; 0 marks a free entry.
+#define TT_BUCKET_ENTRIES 8
+#define TT_BUCKET_BYTES (TT_BUCKET_ENTRIES * sizeof(uint64_t))
+
+// Default memory budget
+#define TT_DEFAULT_BYTES ((size_t)16 << 20)
+
+typedef struct {
+    uint64_t probes;
+    uint64_t hits;    // Probes that cut their subtree
+    uint64_t stores;
+} TransTableStats;
+
+typedef struct {
+    uint64_t *entries;     // Cache-line aligned buckets
+    void *block;           // Allocation the buckets sit in
+    uint64_t bucket_mask;
+    size_t bytes;
+    uint64_t epoch;        // Current solve, pre-shifted into place
+    TransTableStats stats; // Totals over every solve, added atomically
+} TransTable;
+
+#define TT_TAG_MASK (~(uint64_t)0xFFFFFF)
+
+// Largest power-of-two bucket count within the budget (at least one bucket)
+int tt_init(TransTable *tt, size_t budget_bytes);
+void tt_free(TransTable *tt);
+
+// Start a solve: older entries stop matching, and are replaced first
+void tt_begin(TransTable *tt);
+
+// Add a thread's counters to the table's totals
+void tt_add_stats(TransTable *tt, const TransTableStats *stats);
+
+// Look a board up for the current iteration: 1 if it was reached before at
+// no greater depth under the same bound (cut it off), otherwise record this
+// visit, displacing entries from older solves or iterations before the
+// deepest, and return 0
+static inline int tt_visit(TransTable *tt, uint64_t key, int depth, int bound,
+                           TransTableStats *stats) {
+    uint64_t *bucket = tt->entries + (key & tt->bucket_mask) * TT_BUCKET_ENTRIES;
+    uint64_t tag = (key & TT_TAG_MASK) | tt->epoch;
+    int victim = 0;
+    int victim_rank = -1;
+
+    stats->probes++;
+    for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+        uint64_t old = __atomic_load_n(&bucket[i], __ATOMIC_RELAXED);
+        int old_depth = (int)(old >> 8 & 0xFF);
+        int current = (old & 0xFF0000) == tt->epoch && (int)(old & 0xFF) == bound;
+
+        if ((old & ~(uint64_t)0xFFFF) == tag) {
+            if (current && old_depth <= depth) {
+                stats->hits++;
+                return 1;
+            }
+            victim = i;
+            victim_rank = INT_MAX;
+            break;
+        }
+        // Free and stale entries first, then the deepest (smallest subtree)
+        int rank = current ? old_depth : INT_MAX - 1;
+        if (rank > victim_rank) {
+            victim_rank = rank;
+            victim = i;
+        }
+    }
+    if (victim_rank <= depth) {
+        return 0;  // Every entry covers more of the tree than this one would
+    }
+    __atomic_store_n(&bucket[victim], tag | (uint64_t)depth << 8 | (uint64_t)bound,
+                     __ATOMIC_RELAXED);
+    stats->stores++;
+    return 0;
+}
+
+#endif // TRANSTABLE_H